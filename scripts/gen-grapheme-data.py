@@ -14,6 +14,7 @@ DOWNLOADS = [
     f"{BASE_URL}/auxiliary/GraphemeBreakProperty.txt",
     f"{BASE_URL}/DerivedCoreProperties.txt",
     f"{BASE_URL}/auxiliary/GraphemeBreakTest.txt",
+    f"{BASE_URL}/Scripts.txt",
 ]
 
 SRCDIR = Path(__file__).resolve().parent.parent
@@ -45,6 +46,12 @@ INCB_VALUES = {
     "RAQM_INCB_EXTEND": "Extend",
 }
 
+# The merged property value keeps the Grapheme_Cluster_Break in the low four
+# bits and the InCB value in the two above them. The Latin-1 page adds the
+# script, which is either Latin or Common for all of its characters.
+INCB_SHIFT = 4
+LATIN1_SCRIPT_LATIN = 0x40
+
 
 def download(url):
     print(f"Downloading {url}")
@@ -157,6 +164,57 @@ def build_incb_data(derived_core_properties_data):
     return data
 
 
+def build_props_data(grapheme_break, incb):
+    grapheme_break_mapping = {v: i for i, v in enumerate(GRAPHEME_BREAK_VALUES)}
+    incb_mapping = {v: i for i, v in enumerate(INCB_VALUES)}
+    assert len(grapheme_break_mapping) <= 1 << INCB_SHIFT
+
+    data = {}
+    for cp, value in grapheme_break.items():
+        data[cp] = grapheme_break_mapping[value]
+    for cp, value in incb.items():
+        data[cp] = data.get(cp, 0) | incb_mapping[value] << INCB_SHIFT
+    return data
+
+
+def build_latin1_page(props, scripts_data):
+    latin = set()
+    for start, end in parse_ranges(scripts_data, "Latin"):
+        latin.update(range(start, min(end, 0xFF) + 1))
+    common = set()
+    for start, end in parse_ranges(scripts_data, "Common"):
+        common.update(range(start, min(end, 0xFF) + 1))
+
+    other = set(range(0x100)) - latin - common
+    if other:
+        raise ValueError(
+            f"Latin-1 characters neither Latin nor Common: {sorted(other)}. "
+            "Handle their script in the Latin-1 page and in raqm.c."
+        )
+
+    page = []
+    for cp in range(0x100):
+        value = props.get(cp, 0)
+        if cp in latin:
+            value |= LATIN1_SCRIPT_LATIN
+        page.append(value)
+    return page
+
+
+def gen_latin1_page(page):
+    lines = [
+        f"#define RAQM_INCB_SHIFT {INCB_SHIFT}",
+        f"#define RAQM_LATIN1_SCRIPT_LATIN 0x{LATIN1_SCRIPT_LATIN:02X}",
+        "",
+        "static const uint8_t _raqm_latin1_props[256]=",
+        "{",
+    ]
+    for i in range(0, len(page), 16):
+        lines.append("  " + ",".join(f"{v:3d}" for v in page[i : i + 16]) + ",")
+    lines.append("};\n")
+    return "\n".join(lines)
+
+
 def gen_enum(name, values):
     lines = ["typedef enum\n{"]
     for i, member in enumerate(values):
@@ -171,6 +229,7 @@ def main():
     grapheme_break_data = download(DOWNLOADS[1])
     derived_core_properties_data = download(DOWNLOADS[2])
     grapheme_break_test_data = download(DOWNLOADS[3])
+    scripts_data = download(DOWNLOADS[4])
 
     unicode_version = get_unicode_version(grapheme_break_data)
     print(f"Unicode version: {unicode_version}")
@@ -178,18 +237,10 @@ def main():
     grapheme_break = build_grapheme_break_data(emoji_data, grapheme_break_data)
     incb = build_incb_data(derived_core_properties_data)
 
-    grapheme_break_mapping = {v: i for i, v in enumerate(GRAPHEME_BREAK_VALUES)}
-    incb_mapping = {v: i for i, v in enumerate(INCB_VALUES)}
+    props = build_props_data(grapheme_break, incb)
+    latin1_page = build_latin1_page(props, scripts_data)
 
-    grapheme_break_sol = packTab.pack_table(
-        grapheme_break,
-        "RAQM_GRAPHEME_OTHER",
-        mapping=grapheme_break_mapping,
-        compression=9,
-    )
-    incb_sol = packTab.pack_table(
-        incb, "RAQM_INCB_NONE", mapping=incb_mapping, compression=9
-    )
+    props_sol = packTab.pack_table(props, 0, compression=9)
 
     out = io.StringIO()
     out.write(
@@ -207,10 +258,12 @@ def main():
     out.write("\n")
 
     code = packTab.Code("_raqm")
-    grapheme_break_sol.genCode(code, "get_grapheme_break", language="c")
-    incb_sol.genCode(code, "get_incb", language="c")
+    props_sol.genCode(code, "get_grapheme_props", language="c")
     code.print_code(file=out, language="c")
 
+    out.write("\n")
+    out.write(gen_latin1_page(latin1_page))
+
     out.write("\n#endif /* _RAQM_GRAPHEME_DATA_H_ */\n")
 
     OUTFILE.write_text(out.getvalue())
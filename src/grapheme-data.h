@@ -33,366 +33,369 @@ typedef enum
 
 #include <stdint.h>
 
-static const uint8_t _raqm_u8[4446]=
+static const uint8_t _raqm_u8[5297]=
 {
-   33,  0, 48, 84,118,128,144,186,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0, 12,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  9, 10, 11, 12, 13, 14, 15,
-   16, 17, 18,  0, 19, 20, 21, 22,  0, 23, 24, 25, 26, 27, 28, 29,
-    0, 30, 31,  0,  0,  0,  0,  0,  0,  0,  0,  0, 32, 33, 34,  2,
-    3,  4,  5,  6,  7,  8,  2,  3,  4,  5,  6,  7,  8,  2,  3,  4,
-    5,  6,  7,  8, 35,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0, 36,  0, 37, 38, 39,  0,  0,  0, 40, 41,
-   42, 43, 44, 45, 46, 47, 48, 49, 50,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0, 51,  0,  0,  0,  0,  0, 52,  0,  0,  0,  0, 53, 54,
-   55,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0, 56,  0,  0,  0,  0,  0,  0,  0,  0,
-   57, 58, 59,  0,  0,  0, 60,  0,  0, 61, 62, 63, 64, 65,  0,  0,
-    0, 66, 67, 68, 69, 70, 71, 72, 73, 74,  1,  1,  1,  1,  1,  1,
-    1,  0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  1,  1,  1,  1,  1,
-    1,  3,  4,  5,  6,  7,  8,  9,  3,  4,  5,  6,  7,  8,  9,  3,
-    4,  5,  6,  7,  8,  9,  3,  4,  5,  6,  7,  8,  9,  3,  4,  5,
-    6,  7,  8,  9,  3,  4,  5,  6,  7,  8,  9,  3,  4,  5,  6,  7,
-    8,  9,  3,  4,  5,  6,  7,  8,  9, 18, 11, 19,  0,  0,  0,  0,
-    0,  0,  0,  0,  0, 10, 20,  0,  0,  0,  0, 21,  0,  0,  0, 22,
-   23, 24, 25,  0, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,
-   38, 12, 39, 12, 40, 41, 42, 43, 44, 45, 46, 47, 48, 13, 49, 50,
-   51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62,  0, 63, 64, 65,
-   66,  0,  0,  0,  0,  0, 67,  0,  0,  0,  0,  0,  0, 68, 69, 70,
-   71, 72,  0, 73,  0, 74,  0,  0,  0, 75, 76, 77, 78, 79, 80, 81,
-   82, 83,  0,  0, 84,  0,  0,  0, 10, 85, 86,  0, 87, 88,  0, 89,
-    0,  0,  0,  0,  0, 90,  0,  0, 91,  0,  0,  0, 92,  0,  0, 93,
-   94, 95, 96, 97, 98, 99,100,101,  0,  0,  0,  0,  0,102,  0,  0,
-    0,  0,  0,  0,  0,103,104,  0,  0,  0,  0,  0,105,  0,106,  0,
-  107,108,  0,109,  0,  0,  0,  0,  0,  0,  0,110,  0,  0,  0,  0,
-    0,  0,111, 14,112,  0,  0,  0,  0,113,  0,114,115,116,117,118,
-  119,120,121,122,123,  0,  0,  0,124,  3,  4,  5,  6,  7,  8,125,
-  126,  0,  0,  0,  0,127,  0,  0,  0,128,  0,  0, 11,  0,  0, 14,
-  129,  0,  0,  0,  0,  0,  0,  0,130,  0,  0,  0,131,  0,132,  0,
-    0,133,  0,  0,134,  0,  0,  0,  0,  0,  0,  0,  0,135,136,  0,
-    0,  0,  0,137,138,  0,139,140,  0,141,142,143,144,145,146,147,
-  148,149,150,  0,151, 13,152,153,154,155,156,157,158,  0,  0,159,
-  160,161,162,163,  0,164,  0,  0,  0,165,  0,  0,  0,166,167,  0,
-  168,169,170,171,  0,  0,172,  0,  0,173,  0,174,  0,175,176,177,
-    0,  0,  0,  0,178,179,180,  0,  0,181,182,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,183,  0,  0,  0,  0,  0,  0,184, 15,  0,  0,
-    0,  0,  0,  0,  0,  0,185,  0,  0,  0,  0,  0,  0,  0,186,187,
-  188,  0,  0,189,  0,  0,  0,  0,  0,  0,  0,  0,  0,190,191,  0,
-    0,  0,  0,  0,  0,  0,192,193,  0,  0,194,  0,  0,  0,  0,  0,
-    0,195,196,197,  0,  0,  0,  0,  0,198,  0,199,  0, 15,  0,  0,
-    0,  0,  0,200, 16,  0,  0,  0,  0,  0,  0,  0, 16,  0,  0,  0,
-  201,  0,  0,  0,202,  0,  0,  0,  0,  0,  0,  0,203,  0,204,  0,
-    0,205,  0,206,207,  0,208,209,210,211,212,  2,  2,213,  2,214,
-  215,  2,  2,  2,216, 17,217,218,219,  2,220,  2,221,  0,  0,  0,
-  222,223,224,225,226,227,228,  2,  2,  0,229,  2,  2,  0,  0,  0,
-    0,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
-   17,230, 10,  1,  1, 10, 10, 10,231,  0,  0,  0,  0,  1,  1,  1,
-    1,  2,  2,  2,  2,  3,  3,  3,  3,  4,  1,  1,  1,  1,  1,  1,
-    4,  1,  1,  4,  1,  1,  4,  1,  1,  5,  5,  5,  5,  9,  0,  0,
-    0,  7,  0,  0,  0, 10, 10, 10, 10,  8,  8,  8,  8,  0,  0,  0,
-    6,  0,  6,  0,  0, 16, 16, 16, 16,  5, 12,  0,  0,  0,  0,  6,
-    5, 19,  0,  0,  0,  0,  0,  7,  5, 47,  0,  0,  0,  0,  0,  0,
-   20,  0, 29,  0,  0,  0,  0,  0,  7,  0,  0,  0,  3, 49,  0,  0,
-    0,  0,  0,  0, 18,  0,  0, 24,  3, 13,  0,  0,  0, 11,  0,  0,
-    0,  0, 19,  0,  0, 12,  0,  0,  0,  5,  9,  0,  0,  0,  0,  0,
-   17,  0,  0,  3,  3,  0,  0,  0, 52, 14,  5,  5,  5,  0,  7,  5,
-    5,  5,  0,  0, 19, 26,  0,  0,  0, 27, 56, 48, 38, 57,  0,  0,
-    0,  0,  0,  0, 46,  0,  0,  0, 31, 23,  0,  0,  0,  0,  0,  6,
-   55,  5,  5,  5,  9,  0,  0,  0, 14,  0,  0,  0, 19,  7, 11,  0,
-    0,  7,  9,  0,  0,  5,  5,  5, 11,  5,  0,  0,  0,  0,  0, 22,
-    0, 28,  0,  0,  0,  0,  0, 40,  0,  0,  0, 17,  0, 18, 13,  0,
-    0,  0, 24,  0,  0, 13,  0,  0, 18,  0,  0,  0, 32, 15, 15, 15,
-   15,  0,  9,  0,  0,  0,  0,  0,  5,  0, 17,  3,  3,  3,  3,  3,
-   21,  0,  0, 17,  3,  2,  2, 79, 80,  0,  0, 22, 81,  6,  5, 11,
-    0,  5,  5,  5, 36, 29, 36,  0,  0, 64, 65,  0,  0,  5,  5, 12,
-   82,  0,  7,  5, 83,  5, 37, 31, 11,  0,  0,  0, 84,  5,  5, 12,
-    0,  0,  7, 36,  5,  5, 14, 14, 11,  0,  0, 14,  0, 65,  6,  5,
-    5, 66,  5,  5,  5,  0,  0, 53, 46, 27,  5, 33, 54, 14,  5,  0,
-    0,  0,  0,  0, 55, 34,  6, 37, 11, 11, 19,  0,  0, 27, 36, 85,
-   38,  0, 14,  0,  0, 20,  0,  0,  0,  0,  0,  0, 53, 58, 35, 67,
-   38, 33,  9,  0,  0, 33, 68, 31, 11,  0,  0,  0, 69, 59, 68, 31,
-   11, 39,  0,  0,  0, 27, 46, 67, 86,  0,  0, 20,  6, 30, 60, 15,
-   32, 35,  0,  0,  0, 70,  5, 12,  0,  0,  6,  5, 12, 70,  5,  5,
-    9,  0,  0,  5, 12,  0,  0, 11,  0,  0, 71, 19, 35, 14,  5,  5,
-   26,  5, 31,  0, 14,  5,  5, 14,  5,  0, 20,  0,  0, 43,  5, 57,
-   34,  0, 35, 11,  7, 14,  9,  0,  0, 20, 34,  0, 19, 16, 16,  8,
-    8,  0, 44,  5, 23, 15, 72, 27,  5,  0,  0,  6, 87,  0,  0, 19,
-    0, 26, 32, 33,  0, 72, 15, 27,  0,  0,  6, 61,  0,  0, 88,  5,
-   12, 60, 14,  5, 33, 32,  5,  5, 37,  5,  5,  5,  0,  5, 73,  0,
-    0,  0,  5,  5, 23, 30,  9,  0,  0, 74, 23,  5, 11,  0, 53, 23,
-   50,  0, 15, 15,  5,  5, 30,  0,  0, 12,  5,  5,  5, 43,  5,  9,
-   19,  0, 56, 11,  0,  0,  0, 52, 89,  0,  0,  2, 90,  0,  0,  0,
-   13,  0,  3, 21,  0,  0,  0, 13,  0,  3,  0, 25,  0,  0, 28,  0,
-    0,  0,  0, 18, 25,  3, 13,  0, 28, 22, 21, 13, 22, 91, 28, 28,
-   17,  0,  0, 25,  0, 62,  0,  3,  3,  3,  0,  0, 18, 45, 40, 13,
-    0,  0,  0, 18, 17, 17,  3, 51, 13, 21, 18, 17,  0, 21,  0,  0,
-   40,  0, 21, 13, 17, 51, 13,  0,  0,  3, 41, 25, 22, 28, 22,  3,
-   41, 28, 62,  0, 22, 22,  0, 13,  0,  0, 45,  0, 62, 18, 41,  0,
-    0, 22,  0,  0,  0,  0, 21,  0,  0,  0,  0, 18, 13, 13, 22,  0,
-    0, 13,  0,  0, 22,  0,  0, 29,  0,  0, 18, 22,  0, 12,  5,  5,
-   11, 20, 20,  6,  0, 39, 75,  0,  9, 92,  0,  0,  0,  0, 15, 15,
-   15, 15, 11,  0,  0, 11,  0,  0,  6,  0,  7,  5, 11,  0,  6,  5,
-    5, 44,  0,  0,  0, 10, 10, 10, 93,  6, 30, 23, 23,  0,  0, 14,
-   26, 75, 34,  0,  0,  6,  0,  0, 94,  0,  0,  0,  9, 31, 37,  9,
-    7,  0,  0, 39, 23,  0, 95,  0,  0, 39, 54, 58, 38,  1,  0,  0,
-    0, 16, 76, 96,  8,  8,  8,  8,  0,  2,  2,  2,  0,  0,  7, 12,
-    0, 14, 29,  0,  5,  0,  0, 12,  6,  0,  5,  0,  0,  0,  0, 14,
-   11,  0,  0,  6,  9, 97,  0,  0,  0,  0,  0,  5,  5, 37,  9,  0,
-    6, 32, 26, 34, 77, 20,  0,  0, 77,  0,  6,  5, 27,  0, 98,  0,
-    0,  6,  0,  0,  0, 39, 30,  5, 26, 99,  0, 14, 69, 23,  5,  0,
-   20, 32,  5, 12,  0, 33, 48, 48, 38, 35,  7,  5,  9,  0,  0, 61,
-    5, 60, 71, 49, 30,100,  0,  0,  0, 29,  0,  0,  0,  0, 63,  5,
-    5, 30,101,  0,  0, 61,  5, 59, 50, 43,  0,  0,  0, 30, 11, 15,
-   44,  0,  0,  0, 11, 32,  5, 26, 50,  0,  0,  6, 54,  5,  5,  0,
-    0,  0,  0,  0,102,  7, 44,  5,  0,  5,  5, 34,  0, 33,103,104,
-  105,106,  0,  0,  0, 63,  5,  7, 15,  9, 73,  0,  0, 14,  5, 12,
-    0,  6,  5,107, 12, 14, 26, 27,  0,  0, 64,108,  5,  5, 26, 11,
-    0, 43, 59,  0,  0,  0,  0,  0, 39,  5, 12,  5, 44,  7,  5,  5,
-    5,  5,  5, 74,  5, 43, 34,  0,  0, 14, 12, 20, 36,  5, 66,  0,
-    0,  0,  0, 35,109,110, 50,  0,  0,  6, 58,  0,  0,111,  0,  0,
-    0,  0, 30, 12, 35,  0,  0, 20,  0,  9,  6,  5,  5,  5, 11,  0,
-    0,  5,  5, 23, 27, 78, 78, 76,  0, 63, 15, 15, 15, 15, 15,  0,
-    6,  0,  0,  0, 29,  2,  0,  0,  0,  0, 14, 11, 14,112,  2,113,
-    5, 12, 14,  5,  0,  0,  0,  7, 11,  5, 12,  6,  5,  5, 12,  5,
-    5,  5,  5, 37,  5, 36, 31, 12,  0,  6, 20,  0,  7,  0,  5, 12,
-    0,  0, 13,  0,  0,  0,  3,  3,  3, 21,  0,  0, 17,  0,  0,  0,
-   28, 24,  3, 25,  0,  3,114, 42, 42, 42, 42, 42, 42, 24,  3,  3,
-    3,  0,  0, 28,  0, 17,  3, 25,  3, 21,  3,  3,  3,  3, 17, 24,
-   17, 45, 41,115,  5,  3,  3,  3, 41,  0,  0, 24, 25,  3,  3,  0,
-   18, 45,  3, 25,  0,  0, 18, 17, 21, 13, 40,  0,  0,  0, 21, 13,
-    0, 40,  0,  0, 13, 17, 13,  0,  0, 24,  0,  0, 25, 51,  0, 13,
-   18, 18,  0, 17,  3,  3, 21, 18,  3, 25, 24,  3,  3,  3, 21, 51,
-    3, 45,  3,  3,  3, 17,  3,  3,  3,  3,  3, 25,  3,  3, 41,  3,
-    3,  0,  0,221,221, 51, 51,238,238,220,221, 68, 68,  0, 64,  0,
-   68,187,187,  4,  0,153,153, 68,  0, 68,  4, 14,  0, 64, 68,136,
-  136,170,170,  0,238,  0,224, 64,  0,  0,  4,238,  0,224,  0, 68,
-  136,224,238,238, 14, 68,132, 72, 68,  0, 14, 64,  4,136, 68,  4,
-   68,136, 72,132,136, 72,  4,  0,136, 68, 64,  4, 64, 72,  0,  0,
-  128,224, 14,238,224,102,102,132, 68, 68, 72, 14,224,  4,136, 64,
-  136,  8,128, 68,  8, 72, 72,224,224,  0, 48,  0,132, 72,136,  4,
-  132,  4,128, 64,132,132,  8,132,132,  4,  4,132, 72, 14, 14,128,
-  136,119,119,119,  0, 68, 71,  8,136,  8, 68,  4, 72, 64,128, 64,
-   64,136,132,  8,  0,128, 68, 72,132,170, 10,112,  0,  0,160, 51,
-   50, 19, 51, 48, 14,  3,  0,116, 64,  0,112,132,128, 72,  7, 68,
-   67,128,132, 84, 51, 51,  3, 14,238,136,  0,  9,  0,132,  0,128,
-    4,  0,176, 72,  8,128,  8,  4,119,116,  4,132,  4, 64, 72,136,
-  128,  8, 64, 68,116,120, 72,132, 64,119, 68,136,  8, 68,128, 68,
-  135, 68, 52, 51, 67,238,102,238, 78, 33,  0, 48, 64,101,112,128,
-  169,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0, 11,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  0, 10, 11, 12,
-   13,  0, 14,  0,  0,  0,  0,  0, 15,  0, 16,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0, 17, 18, 19,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 20,
-    0, 21, 22, 23,  0,  0,  0, 24, 25, 26, 27, 28, 29, 30, 31, 32,
-   33, 34,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 35,  0,  0,  0,
-    0,  0, 36,  0,  0,  0,  0, 37,  0, 38,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-   39,  0,  0,  0,  0,  0,  0,  0,  0, 40, 41, 42,  0,  0,  0, 43,
-    0,  0, 44, 45, 46, 47, 48,  0,  0,  0,  0, 49,  0,  0,  0,  0,
-    0,  0, 50,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  1,  8,  0,  0,  0,  0,  9,  0,  0,  0, 10, 11, 12, 13,
-    0, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28,
-   29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,  2, 41, 42, 43,
-   44, 45, 46, 47, 48, 49, 50, 51, 52,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0, 53,  0,  0,  0,  0,  0,  0, 54, 55, 56, 57, 58,  0,
-   59,  0, 60,  0,  0,  0, 61, 62, 63, 64, 65, 66, 67, 68, 69,  0,
-    0, 70,  0,  0,  0,  1, 71,  0,  0, 72,  0,  0,  0,  0,  0,  0,
-    0, 73,  0, 74,  0,  3, 75,  0, 76,  0,  0,  0,  0,  0,  0, 77,
-    4, 78,  0,  0,  0,  0, 79,  0,  0, 80, 81, 82, 83, 84, 85, 86,
-   87, 88,  0,  0,  0, 89,  0,  0,  0,  0, 90,  0,  0,  0, 91,  0,
-    0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,  0, 92,  0,  0,
-    0, 93,  0, 94,  0,  0, 95,  0,  0, 96,  0,  0,  0,  0,  0,  0,
-    0,  0, 97, 98,  0,  0,  0,  0, 99,100,  0,101,102,  0,103,104,
-  105,106,107,108,109,110,111,  2,  0,112,113,114,115,116,117,118,
-  119,120,  0,  0,121,122,123,124,125,  0,126,  0,  0,  0,127,  0,
-    0,  0,128,129,  0,130,131,132,133,  0,  0,134,  0,  0,135,  0,
-  136,  0,137,138,139,  0,  0,  0,  0,140,141,142,  0,  0,  0,143,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,144,  0,  0,  0,  0,  0,
-    0,145,  5,  0,  0,  0,  0,  0,  0,  0,  0,  6,146,147,  0,  0,
-  148,  0,  0,  0,  0,  0,  0,  0,  0,  0,149,150,  0,  0,  0,  0,
-    0,  0,  0,151,152,  0,  0,153,  0,  0,  0,  0,  0,  0,154,155,
-  156,  0,  0,  0,  0,  0,157,  0,  6,  0,  5,  0,  0,  0,  0,  0,
-  158,  7,  0,  0,  0,  0,  0,  0,  0,  7,  0,  0,  0,159,  0,  0,
-    0,160,  0,  0,  0,  0,  0,  0,  0,161,  0,162,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,163,  3,  1,  0,  0,  1,  1,  1,  1,  0,  0,
-    0,  0,  1,  1,  1,  1,  4,  0,  0,  0,  0,  0,  1,  1,  0, 13,
-    0,  0,  0,  0,  0, 10,  3,  0,  0,  0,  0,  0, 20,  0,  1,  1,
-    1,  0, 38,  0,  0,  0,  0, 21,  1, 39, 40,  0,  0,  0,  0, 22,
-    0,  0,  9,  1,  0,  6,  0, 41, 42,  0,  0,  4,  0,  1, 22,  0,
-    0,  0,  0,  0, 23,  6,  0,  0,  9, 43,  0, 44, 45,  0,  0, 46,
-    0,  0,  0, 24,  0,  0, 14,  1, 47,  1, 25,  8,  2, 48, 49, 50,
-    5, 51,  4,  8, 11, 52, 15, 53,  5, 54, 16,  0,  0, 55, 56,  4,
-    0, 57, 16,  8, 11, 58, 59,  0,  5, 60,  4,  8, 11, 61, 15, 62,
-    5, 63, 26,  0,  0, 12, 27, 17,  0,  0, 64,  8, 11, 65, 66, 67,
-    5,  0,  4,  0,  0, 68, 69, 18,  5,  0,  7,  8,  2, 70, 15, 17,
-    5,  0, 71, 72,  0,  0,  0,  0,  0, 73, 74,  0,  0,  0,  0,  0,
-    0, 75, 76,  0,  0,  0,  0, 77,  0, 78,  0,  0,  0, 79, 80, 81,
-    1, 28, 82,  0,  0,  0,  2,  2, 83, 84,  0, 85, 86, 87, 88, 19,
-    0,  0,  0, 89,  0,  0,  0, 29,  0, 30,  0,  5,  0,  5,  2,  2,
-    2, 90, 91, 92,  0,  0, 93,  0,  0,  0, 18,  0, 94,  0,  0,  0,
-   95, 96,  0, 97,  2,  2,  2, 98, 99,100,  0,  0,  0,  1,  1, 31,
-  101,  0,102,103,  2,104,105,  0,  9, 32,106,  2,107,108,  0,  0,
-  109, 32,  0,  0, 20,110,  0,111,112,113, 19,  0,  0,  0,  0,  1,
-    1,  6,  0,  0,  3,  7,  0,  0,  0,  3,  0,  0, 14,  0,  0,114,
-    0,  0,  0,  0,  3,115,  0,  0,  0,  7,116,  0,117,  0,118,  0,
-    1,119,  0,  0,120,  0, 24,121,  0,  0,122,  2,  2,123,124,  0,
-  125,126,  0,  0,127,128,129,  0,  2,130,  0,  0,  0,131,  4,  0,
-  132,133,  2,134,135,  0,  0, 12,  0,  0,  1,  0,  1,  0,  0,  0,
-    0, 19,  0,  0,  6,  0,  0,  0,  0,136,137,138,  2,139,  0,  0,
-   18,  0,  0,  0,140,  0,  0,  0,141,  0,  0,  0,142,  0,  0,  0,
-    0, 14, 23,  6,  0,  0, 29,  0,  0,  0,  4,  0,  0, 33, 10,  0,
-    0,143,  7,  0,  0,144, 26,  0,  0,  0,145,  2,146,147,148,  0,
-    0, 34,  7,  0,  0,149,150,  0,  0,  0,  0,  0,  3,151,  0,  3,
-  152,  0,  7,  0,  0,153, 27, 17,154, 35,155,  2,  2,156,157,158,
-   16,  0,  0,  0,  0, 33,159, 12,  0,  0,  0,  0,  0,160,161,  0,
-    0,  0,  0,  0,  3,162,  6,163,  0,  0,  0,  0,  0,164,  6,  0,
-    0,  0,  0,  0,165,166,  0,167,168,  0,  0,  0,  3,169,170,171,
-    2,172, 34,  0,  0,  0,  0,173,  6,  0,174,  2,  2,175,176,177,
-    2,  2,178,179,  0,  0,  0,  0,180,  0,  0,  0,  0,181,  0,182,
-  183,184,  0,  0,  0,185,186,  0,  0,  0,  0,187,  0,  0,  0,  0,
-    0,188,189,190,  2,191,192,193,  0,  0,194,195,  0,  0,  0, 13,
-  196,  0,  0,  0,  0, 35,  3, 25,  0,  0,  0,  0, 36,  7,  0,197,
-    0,  0,  1,  1, 31,  1, 10,  0,  0,  0,  0,  0,198,199,200,  0,
-  201,  0, 30,  0,  0,  0,  1,  1,  1,202,  1,  1, 28, 37, 36,  9,
-   21,  0,203,204,205,  0,  0,  0, 12,  0,  0,  0, 13,  0,  0,  0,
-  206, 37,  0, 10,  0,  0,207,  0,  0,  0,  0,  0,  0,  9,  0,  0,
-    0,  0,255,255,255,255, 85, 85, 85, 85,  0,  0,  0,192, 12,  0,
-    0,  0,240,  0,  0,  0,  3,  0,  0,  0, 15,  0,  0,  0,  0, 84,
-   85, 85,  0,  0,192,255,255, 63,  0,  0, 85, 85, 81, 85,  0,  0,
-    0, 48,  0,  0,  0,240,  0,  0,240,255,252,  3,  0,  8, 60,  0,
-    0,  0,  0,192,  0,  0,  0, 60,  0,  0,  0,  0,  0, 12,  0,  0,
-    0,255,252,255,255,255,255,255, 63,  0,  0,240,255,255,  0,192,
-  255,255, 63,  0,  0,  0, 48,  0,  0,  0,  3,  0,  0, 12,255,255,
-  255,  3,240, 15,  0,  0,240,  3,  0,  0,255,255,255, 15,255,  0,
-    0,  0,  0,  0,255,255,192,  0,  0,  0,255,  3,  0,  0,  0,  3,
-    0,  0,  0, 12,  0,  0,192,255, 15,  0,255,255,255,207, 60,207,
-    0,  0,  0,240,255,195,255,195,243, 15,255,  0,  0, 12,  0,240,
-  207,255,255,252,252, 15,  0,  0,252,  0,207,255,255,255, 85, 85,
-   53,  3,252,255,  3,  8,252,255, 85, 85,  0,  0, 85, 85, 17, 80,
-    5, 51,  0,192,  0, 69,  5,  0,  0, 48,  0,  0,  0,  3, 60,192,
-  195, 15, 15, 12,  0,  0, 81, 84,  5,  3,252,207,  3,  8,  0,  0,
-  244,255, 81, 84,  5,243,  0,252,  0, 69,  4,  0,  0,  0,  3,  3,
-    0,  0, 85, 85,  5,243,  3,240,243, 11,  0, 60, 21,  0,  0,  0,
-    0,195, 51,240,243, 15, 85, 85,213, 51,  0,  0, 48,192,240, 51,
-    0,192, 12,255, 63,  0,  0,192,255, 63, 12,255,255,  3,  0,  0,
-  255, 63,  0,  0, 15,  0,  0,204, 12,  0,252,255,255, 63,255,243,
-    0,252,255,255,252,255,  0, 48,  0,  0, 85, 85, 21,252,243,255,
-   56,124, 85,  5, 95,245,  7, 20,  0, 80,253, 87, 85, 85, 53, 60,
-    0, 28,  0,  0,  0,252, 85,207,255, 15,  0, 48,252,255,239,  0,
-    0, 12,  0,  0,192,207,  0,  0, 12,  0, 63,192,  3,  0, 48,  0,
-  252,  0,  0,192,195,  0, 85, 49,255, 63, 50,252,255,  3,192,255,
-  255,195,255,255,255,  0,255,  0, 64,  1, 64, 85, 85, 85, 85,255,
-  255, 15,240, 86, 85,  1, 79, 85, 85, 85,241, 15,191, 95,  0,  0,
-   64,  5,  0, 48, 15,204,255,240,  0,  0, 63,255,255,255,243,255,
-    3, 12,  0,  3, 15,  0,  0,  0, 60,  0, 63,255,255, 15, 48, 48,
-  192,  0,  0, 60,  0,  3,  0, 15,  0,  0, 15,  0,  0,192,  0,240,
-  255, 15,207,  0,  0,  0, 63,  0, 84, 64,213,240, 15, 15,  2,  0,
-    0,  0, 85, 77, 85, 85,  0,  0, 80, 21,  0,  0,252, 63, 60, 60,
-    0,  0,192,  0,  0,  3, 84,  0, 16, 83,243,195,  3,240, 85, 85,
-   21, 15,  0, 32,  0,  0, 85, 85, 21,  0,  0, 12,  3, 12,  0,240,
-   63,  0,253, 60,  0,255, 85, 84, 84, 85, 85,  5, 63,128,  0,255,
-    0,  0,  0,  0,252, 15,  0,  0,192,  3,195,  3,  0,192,192, 63,
-   60,  0,127, 85, 85, 85, 85,213,255,252,191,  3,  0,  0,  0, 65,
-    0,  0,  0,240,255, 63,  3,  0,252,195, 15,255,  0, 48,192,255,
-   63,  0,  0,  0,192, 51,  0,240,255,  3, 85, 85, 69, 16, 85,  5,
-  195,255, 51,204, 15,240, 50,  0,  0,  0,240, 51,  0,  0,195,255,
-   51,204,243,  0,  0,  0,240, 15,  0,207,  0,  0,  0, 15,192,255,
-   63,204,  0,  0,192, 12,255,255,  0,  0,  0,  0,  0,204,240,207,
-  255,  0,255,255, 60,  0, 85, 21,  4, 85, 85, 20, 85, 85,  3,  0,
-  192, 47,  0,255,240,  0,253,255,127, 85,213,255,195, 63,  0,128,
-    0,  0,253, 63,252, 85, 85,  0,240,255,255, 63, 11,  0,243, 51,
-    0,  0,255, 63,255,207,240,255,255,255,255,255,240,255,243, 60,
-    0,  0,252, 63, 48,207,255,207,  0,  0, 15,204,  0,  0,192,  3,
-    0,  0, 15, 85, 85, 85, 81, 85, 85, 85, 85,240, 63,  0, 47,  0,
-    0,  0,  0,  0, 48,  0,  3,192,255,255,255, 15,  0,  0,255,255,
-   15,252,  0,  0,  0, 60,  0,252, 15,252, 63,  0,192,255, 63,252,
-  255,  0,  0,  0,240, 15,255, 63,192,255,255, 63,255,255,255,255,
-  195,255,207,243, 63,  0,192, 48,  0,240,  0,255, 63,  0,
-};
-static const uint16_t _raqm_u16[928]=
-{
-     0,   0,   0,   0,   8,   8,   8,   8,  12,  12,  12,  12,  16,  20,   4,  24,
-     4,  28,   4,  16,  20,   4,  24,   4,  28,   4,  16,  20,   4,  24,   4,  28,
-     4,  16,  20,   4,  24,   4,  28,   4,  32,  32,  32,  32,   0,   0,   0, 140,
-   164,   0,   0, 168, 176,   0,   0, 180,   0,  92,   0,   0,   0,   0,   0,  64,
-     0,   0, 252,   0,  12,  12,  12, 260, 268,   8,   0,   0,   8,   8, 272,   0,
-    32,  32,  32,   0, 276,   0,   0,   0,   0, 144,  32, 280, 284,   0,   0,   0,
-   288, 292,   0,   0,  68,  32,   0,  36,   0, 296, 300,   0, 304,  72,   0,  32,
-   308,   0,   0,   0,   0,   0, 148,  36,   0,   0,  68, 152,   0, 312, 316,   0,
-     0, 320,   0,   0,   0, 324,   0,   0,  76,  32, 328,  32, 156,   0,   0, 332,
-   336, 340,  40,   0,  80,   0,   0, 344, 160,  56,  40,  84, 348,  72,   0, 352,
-   356,   0,  40,  76,  80,   0,   0, 172, 160, 360,  40,   0, 364,   0,   0, 368,
-   372,  56,   0,   0, 376,   0,   0, 172, 380,  88,  40,   0,  80,   0,   0, 384,
-   388,  88,  40, 392, 396,  56,  40,   0,  80,   0,   0,   0, 400, 404,   0, 408,
-     0,   0,   0, 412, 416,   0,   0,   0,   0,   0,   0, 420, 424,   0,   0,   0,
-     0, 428,   0, 432,   0,   0,   0, 436, 440, 444,  32, 184, 448,   0,   0,   0,
-     0,   0, 188, 452,   0, 456,  36, 460, 464, 192,   0,   0,  44,  44,  44,  44,
-    44,  44,  60,  60,  60,  60, 468,  48,  48,  48,  48,  48,   0, 188,   0,   0,
-     0, 196,   0, 200,   0,  40,   0,  40,   0,   0,   0, 472, 476, 152,   0,   0,
-   480,   0,   0,   0,  88,   0, 484,   0,   0,   0, 488, 492,   0, 496,   0,   0,
-     0, 500, 504, 508,   0,   0,   0,  32,  32, 204, 512,   0, 516,   0,   0, 520,
-   524,   0,  68, 208, 100,   0, 528,   0,   0,   0, 532, 208,   0,   0, 536, 540,
-     0, 544, 548, 552, 556,   0, 560, 564, 212,   0,   8,   0,   0,  32,  32,  36,
-     0,   0, 216, 212,   0, 568, 220,   0,   0, 224, 572,   0, 104,   0, 108, 576,
-   216,   0,   0,   0,   0,   0, 224, 580, 112,   0,   0, 584, 588, 592, 596, 600,
-   604, 608, 612, 616,   0, 620, 624, 628, 632, 636, 220, 640, 644, 648, 652, 228,
-   656, 660, 228,   0,   0, 232, 664, 236,   0,   0,   0, 668, 232, 672,   0,   0,
-     0, 676,   0,   0,   0,   0,  52, 116,   0,   0,   0,  52,   0,   0,  32,  32,
-     0,   0,  76, 680,   0, 684,   0,   0,   0, 688,   0,   0,   0,   0,  52, 692,
-     0,   0,   0, 116, 696,   0, 700,   0, 704,   0,   0, 708, 712,   0,  32, 716,
-     0,   0, 720,   0, 724, 728,  44, 732, 156,   0,   0, 736,  36,   0, 120,   0,
-     0,   0, 740, 744, 748,   0,   0, 752,   0,   0,   0, 756,  72,   0, 760, 764,
-     0,   0, 768,   0,  24,   4, 772,  60, 776,  48,  48, 780,   0,  84,   0,   0,
-    32,   0,  32,   0,   0,   0,   0, 784,   0,   0,   0, 192,   0,   0,  36,   0,
-     0,   0,   0, 788, 792,   0,   0, 796,   0,   0,  88,   0,   0,   0, 800,   0,
-     0,   0, 804,   0,   0,   0, 808,   0,   0,   0,   0,  76, 148,  36,   0,   0,
-   196,   0,   0,   0, 812,   0,   0, 816,  64,   0,   0, 820, 100,   0,   0, 824,
-   828,   0,   0,   0, 124,   0, 832, 128, 836,   0,   0, 840, 100,   0,   0, 844,
-   848,   0,   0,   0,   0,   0, 240, 852,  72,   0,   0,   0,   0,  52, 856,   0,
-   860,  56, 864, 128,   0,   0,   0, 868, 872, 876, 880,   0,   0,   0,   0, 884,
-   888,  84,   0,   0,   0,   0,   0, 892, 896,   0,   0,   0,   0,   0,  52, 900,
-    36, 904,   0,   0,   0,   0,   0, 908,  36,   0,   0,   0,   0,   0, 912, 916,
-     0, 920, 924,   0,   0,   0, 240, 928,   0,   0,   0, 932, 936,   0,   0,   0,
-     0, 940, 944,   0, 948,   0,   0, 952,  56, 956,   0,   0, 960, 964,   0,   0,
-     0,   0, 968,   0,   0,   0, 972, 976,   0, 980, 984, 988,   0,   0,   0, 992,
-   996,   0,   0,   0,1000,1004,   0,   0,   0,   0,   0,1008,1012,   0,   0,1016,
-   124,1020,   0,   0,   0,   0,   0,   8,1024,1028,   0,   0,   0,  92,1032,   0,
-     0,   0,   0, 128,   0,   0,1036,   0,  52,1040, 244, 244,1044, 124,   0,   0,
-     0,   0, 248, 116,   0,1048,1052,   0,  32,  32, 204,  32,  64,   0,   0,   0,
-     0,   0,1056,1060,1064,   0,1068,   0, 200,   0,   0,   0,  32,  32,  32,1072,
-    32,  32, 184, 120, 248,  68, 144,   0,1076,1080,1084,   0,  52,   0,   0,   0,
-     0,   0,  84,   0,   0,   0,  92,   0,   0,   0,1088, 120,   0,  64,   0,   0,
-  1092,   0,   0,   0,1096,   0,  96,   0,   0,1100, 104, 112, 236, 112,   0, 256,
-     0,   0,   0,1104,1108,1112, 132,  12,  12,  12,1116,1120,1124,1128, 104,1132,
-   108,  12, 256,  12,  12,  12,1136,  12,  12,1140,  12,  12,  12,  12,  12,1144,
-    12,  12,  12,1148,1152,  12,1156,1160,1164,1168,1172,1176,1180,1184,1188,1192,
-    12,   0,   0,   0,1196,1200,1204,1208,   0, 264,  12,  12,  96,   0,   0,   0,
-   136, 264,   0,   0, 136,   0, 132,  96,1212, 108,  12,  12,  96,  12,  12,1216,
-  1220,  12,  12,  12,   0, 136, 132,  12,   8,   8,  32,  32,  32,  32,  32,   8,
+    0,  1,  2,  2,  2,  3,  4,  5,  6,  7,  2,  8,  2,  9, 10, 11,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+    2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+   12,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+   10, 15, 16, 17, 18, 19, 20, 21, 10, 22, 23, 10, 10, 10, 10, 10,
+   10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+   10, 10, 10, 10, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 27, 28,
+   29, 30, 31, 32, 33, 27, 28, 29, 30, 31, 32, 33, 34, 10, 10, 10,
+   10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 35, 10,
+   36, 37, 38, 10, 10, 10, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
+   49, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 50, 10, 10, 10, 10,
+   10, 51, 10, 10, 10, 10, 52, 53, 54, 10, 10, 10, 10, 10, 10, 10,
+   10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 55,
+   10, 10, 10, 10, 10, 10, 10, 10, 56, 57, 58, 10, 10, 10, 59, 10,
+   10, 60, 61, 62, 63, 64, 10, 10, 10, 65, 66, 67, 68, 69, 70, 71,
+   72, 73, 74, 74, 74, 74, 74, 74, 74, 10, 10, 10, 10, 10, 10, 10,
+   10,  0,  1,  2,  3,  3,  3,  3,  3,  3,  3,  3,  3,  4,  5,  3,
+    3,  3,  3,  6,  3,  3,  3,  7,  8,  9, 10,  3, 11, 12, 13, 14,
+   15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30,
+   31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46,
+   47, 48, 49, 50,  3, 51, 52, 53, 54,  3,  3,  3,  3,  3, 55,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 56, 57, 58,
+   59, 60,  3, 61,  3, 62,  3,  3,  3, 63, 64, 65, 66, 67, 68, 69,
+   70, 71,  3,  3, 72,  3,  3,  3,  4, 73, 74,  3, 75, 76,  3, 77,
+    3,  3,  3,  3,  3, 78,  3,  3, 79,  3,  3,  3, 80,  3,  3, 81,
+   82, 83, 84, 85, 86, 87, 88, 89,  3,  3,  3,  3,  3, 90,  3,  3,
+    3,  3,  3,  3,  3, 91, 92,  3,  3,  3,  3,  3, 93,  3, 94,  3,
+   95, 96,  3, 97,  3,  3,  3,  3,  3,  3,  3, 98,  3,  3,  3,  3,
+    3,  3, 99,100,101,  3,  3,  3,  3,102,  3,103,104,105,106,107,
+  108,109,110,111,112,  3,  3,  3,113,114,115,116,117,118,119,120,
+  114,115,116,117,118,119,120,114,115,116,117,118,119,120,114,115,
+  116,117,118,119,120,114,115,116,117,118,119,120,114,115,116,117,
+  118,119,120,114,115,116,117,118,119,120,114,115,116,117,118,119,
+  120,114,115,116,117,118,119,121,122,  3,  3,  3,  3,123,  3,  3,
+    3,124,  3,  3,  1,  3,  3,100,125,  3,  3,  3,  3,  3,  3,  3,
+  126,  3,  3,  3,127,  3,128,  3,  3,129,  3,  3,130,  3,  3,  3,
+    3,  3,  3,  3,  3,131,132,  3,  3,  3,  3,133,134,  3,135,136,
+    3,137,138,139,140,141,142,143,144,145,146,  3,147,148,149,150,
+  151,152,153,154,155,  3,  3,156,157,158,159,160,  3,161,  3,  3,
+    3,162,  3,  3,  3,163,164,  3,165,166,167,168,  3,  3,169,  3,
+    3,170,  3,171,  3,172,173,174,  3,  3,  3,  3,175,176,177,  3,
+    3,178,179,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,180,  3,  3,
+    3,  3,  3,  3,181,182,  3,  3,  3,  3,  3,  3,  3,  3,183,  3,
+    3,  3,  3,  3,  3,  3,184,185,186,  3,  3,187,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,188,189,  3,  3,  3,  3,  3,  3,  3,190,191,
+    3,  3,192,  3,  3,  3,  3,  3,  3,193,194,195,  3,  3,  3,  3,
+    3,196,  3,197,  3,182,  3,  3,  3,  3,  3,198,199,  3,  3,  3,
+    3,  3,  3,  3,199,  3,  3,  3,200,  3,  3,  3,201,  3,  3,  3,
+    3,  3,  3,  3,202,  3,203,  3,  3,204,  3,205,206,  3,207,208,
+  209,210,211,212,212,213,212,214,215,212,212,212,216,217,218,219,
+  220,212,221,212,222,  3,  3,  3,223,224,225,226,227,228,229,212,
+  212,  3,230,212,212,  3,  3,  3,  3,212,212,212,212,212,212,212,
+  212,212,212,212,212,212,212,212,217,231,  4,232,232,  4,  4,  4,
+  233,232,232,232,232,232,232,232,232,  0,  0,  1,  2,  0,  0,  0,
+    0,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  4,  0,  0,  0,  0,  0,  0,  0,
+    0,  3,  3,  5,  6,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  3,  3,  3,  3,  8,  7,  9,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 10,  7,  7,
+    7,  7,  7,  7,  7,  7,  7,  7, 11, 12, 11,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3, 13, 14,  3,  3,  7,  7, 15,
+   16,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  8,  7,  7,  7,  7,
+    7,  3,  3,  3,  3, 17,  3,  3,  3,  3,  3,  3,  3,  3, 18,  7,
+   19,  7, 20, 21,  9,  3,  3,  3,  3,  3,  3,  3, 22, 23,  3,  3,
+    3,  3,  3,  3,  3,  7,  7,  7,  7,  7,  7, 15,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 18,  7,  7, 17,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  8,  7,  7,  3,  3, 23,  3,  3,  3,  3,  3, 18, 11,
+    7,  7, 10, 10,  9,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 10,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 14,  8,  7,
+    7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 18,  7,  7,  7,  7,
+    7, 24,  7,  7,  7,  7,  7,  7,  7, 25,  3,  3,  3,  3, 26, 27,
+   27, 27, 27, 27, 27, 27, 27, 28, 29, 30,  7, 31, 32, 10,  7, 27,
+   27, 18,  3,  3,  3,  3,  3, 27, 27, 33,  3,  3,  3,  3, 26, 27,
+   27, 27, 27, 34, 27, 35, 36, 37, 38, 30, 39, 40, 41,  3,  8,  3,
+   42, 18,  3,  3,  3, 37,  3,  3, 43, 44,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3, 29, 45,  8, 20,  9, 23,  3,  3,
+    3,  3,  3,  3,  3,  9, 23,  3,  3, 44,  3,  3,  3,  3, 26, 27,
+   27, 27, 27, 34, 27, 34, 26, 37, 29, 30, 11, 46, 41,  3,  3,  3,
+    3, 18,  3,  3,  3,  3,  3, 47,  7, 33,  3,  3,  3,  3, 26, 27,
+   27, 27, 27, 34, 27, 34, 26, 37, 21, 30, 39, 40, 41,  3, 10,  3,
+   42, 18,  3,  3,  3, 48,  3,  3,  3, 43,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3, 49, 50, 51, 52, 53,  3,  8,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3, 31, 17,  3,  3,  3, 26, 27,
+   27, 27, 27, 34, 27, 27, 27, 37, 21, 31, 54, 21, 55,  3, 12, 56,
+    3, 18,  3,  3,  3,  3,  3,  3,  3, 33,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3, 57, 58, 54, 21,  9,  3, 12,  3,
+    3, 18,  3,  3,  3, 59,  3,  3,  3, 60,  3,  3,  3,  3, 26, 27,
+   27, 27, 27, 27, 27, 27, 27, 61, 38, 30, 29, 52, 62,  3,  8,  3,
+    3, 18,  3,  3,  3,  3,  3,  3,  3, 33,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 43,  8, 63, 64, 65,
+   66,  3,  3,  3,  3, 51,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 67,  7, 15,  3,  3,  8,  7, 15,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 67,  7,  7, 17,  3,  3,  7, 15,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  9,
+    3,  3,  3,  3,  3,  3, 68, 23, 51,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 10,  7,  7, 25,  7, 21,  3, 10,  7,  7, 10,
+    7,  7,  7,  7,  7,  7,  7,  7, 17,  3, 43,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3, 27, 27, 27, 27, 27, 27, 27,
+   27, 27, 27, 56, 10, 69,  7, 70, 71,  3,  3,  3,  3, 27, 72, 73,
+   74, 75, 76,  3, 36, 77, 78, 27, 27, 79, 45,  3, 80,  3,  3,  3,
+   23,  3,  3,  3,  3,  3,  3,  3,  3, 81, 81, 81, 81, 81, 81, 81,
+   81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81, 81,
+   81, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82, 82,
+   82, 82, 82, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+   83, 83, 83, 83, 83, 83, 83, 83, 83,  3,  3,  3,  3,  3,  3,  3,
+   10,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 18,  9,  3,
+    3,  3,  3,  3,  3, 18, 17,  3,  3,  3,  3,  3,  3, 18,  3,  3,
+    3,  3,  3,  3,  3, 18,  3,  3,  3, 27, 27, 27, 27, 27, 27, 27,
+   27, 27, 27, 27, 27, 27, 84,  7, 60, 65, 85, 30,  7, 86,  3,  3,
+   23,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  8, 87,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 12,  3,  3,  3,  3,  3,
+    3,  3,  3, 23,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3, 25, 66, 31,  3, 85, 65, 30,  3,  3,  3,  3,  3,  3,  8, 88,
+    3, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 89,  7,
+   15, 90, 10,  7, 31, 66,  7,  7, 20,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+    9,  7,  7,  7,  3,  3,  3,  3,  3,  7, 91, 92, 93, 92, 27, 27,
+   27, 27, 27, 27, 27, 27,  7,  7, 60, 63, 94, 27, 93,  3,  3,  3,
+    3,  3,  3,  8,  7,  7,  3,  3,  3, 95, 27, 27, 27, 27, 27, 27,
+   27, 96, 60, 97, 73,  3,  3, 92, 37,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 49, 60, 98,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 65, 65,  7,  7, 63,  3,  3,  3,  3,  3,  3, 15,  7,  7,
+    7, 69,  7, 17, 23,  3, 39,  9,  3,  3,  3,  4, 99,  3,  3,  3,
+    3,  3,  3,  0,100,  3,  3,  3,101,  3,  3,  5,  3,  3,  3,  3,
+    3,  0,  0,  0,  0,  3,  3,  3,  3,  3,  3,  3,  3,  7,  7,  7,
+    7,  7,  7,  7,  7, 17,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,102,  3,  3,  3,  3,  3,  5,  3,  3,  3,  3,  3,  3,103,104,
+    3,  3,  3,105,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,106,
+    3,  3,  3,101,  3,  3,  3,  3,  3,  3,  3,  3,107,  3,  3,  3,
+    3,  3,  3,108,103,103,  3,109,  3,102,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,106,  3,  3,102,  3,  3,101,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,107,109,103,101,  3,102,  5,104,101,
+    5,110,102,102,106,  3,  3,109,  3,111,  3,103,103,103,  3,  3,
+  107,112,105,101,  3,  3,  3,107,106,  3,  3,  3,  3,106,103,113,
+  101,104,107,106,  3,104,  3,  3,105,  3,104,101,106,113,101,  3,
+    3,  3,  3,105,  3,103,114,109,  5,102,  5,103,114,102,111,  3,
+    5,  5,  3,101,  3,107,101,  3,  3,  3,112,  3,111,107,114,  3,
+    3,107,101,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,108,  3,
+    3,  5,  3,  3,  3,101,  3,  3,107,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,104,  3,  3,  3,108,  3,  3,  3,  3,107,
+  101,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,101,  5,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  8,  9,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  8,  3,  3,  3,  3,  3,  3,  3,
+    3,  7,  7,  7,  7,  7,  7,  7,  7,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3, 18,  7,101,  3,  3,  5,  3,  3,  3,  3,  3,  3, 12,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,107,  5,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  8, 15,  7,  7,  9,  3,  3,  3,  3,  3,  3,  3,
+   18,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  9,  3,  3,  3, 43, 43,  8,  3,  3,  3,  3,
+    3, 59,115,  3, 17,  3,  3,  3,  3,116,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3, 65, 65, 65, 65,  9,  3,  3,  3,  3,  3,
+    3,  7,  7,  7,  7,  9,  3,  3,  8,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 18,  7,  9,  3,  3,  3,  3,  3,  8,  7,  7, 84,  3,  3,
+    3, 81, 81, 81, 81, 81, 81, 81,117, 25,  3, 26, 92, 27, 27, 27,
+   27, 27, 27, 27, 27, 61, 63, 60, 60,118,  3,  3,  3,  3,  3,  3,
+    3, 27,119, 27, 27,  3,  3, 36, 56,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3, 10, 25,115, 45,  3,  3,  8,  3,  3,120,  3,  3,  3,
+    3, 27, 27, 27, 27, 26,  3,121,122,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 21, 20, 17, 18, 23,  3,  3,  3,  3,  3,  3,
+    3, 27, 27,123, 60,  3,124,  3,  3, 27, 27, 27, 27, 27, 27, 56,
+    3, 59,125, 50, 53,  3,  3,  3,  3,126,127,127,127,127,127,127,
+  126,127,127,127,127,127,127,126,127,127,127,127,127,127,126,127,
+  127,127,127,127,127,126,127,127,127,127,127,127,126,127,127,127,
+  127,127,127,126,127,127,127,127,127,127,126,127,127,127,127,127,
+  127,126,127,127,127,127,127,127,126,127,127,127,127,127,127,126,
+  127,127,127,127,127,127,126,127,127,127,127,127,127,126,127,127,
+  127,127,127,127,126,127,127,127,127,127,127,126,127,127,127,127,
+  127,127,126,127,127,127,127,127,127,127,127,126,127,127,127,127,
+  127,127,  3,  3,  3, 82, 82, 82, 82, 82,128,129, 83, 83, 83, 83,
+   83, 83, 83, 83, 83, 83, 83, 83,  3,  3,  3,  3,  3,  3,  3,  3,
+   43,  3,  3,  3,  3,  3,  3,  3,  3,  7,  7,  7,  7,  3,  3,  3,
+    3,  7,  7,  7,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  0,  0,  0,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3, 23,  3,  3,  3,  3,  3,  3,  3,
+    3, 17,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3, 18, 15,  3, 77, 12,  3,  7, 27, 26, 26,
+   27, 27, 27, 27, 27, 27, 37, 15,130,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 12,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3, 10,  9,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  8, 17,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3, 18,  7,  3, 18,  7,  7, 17,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3, 18,  9,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,131,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  7,  7,  7, 15,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 20, 17,  3,  8,132,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 66, 25, 45,133, 43,  3,  3,133,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,134, 27, 27, 27, 27, 27, 27,
+   27, 27, 61,  7, 30, 97, 17,  3,  3,  3,135,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  8,  3,  3,  3,132,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 59, 63,  7, 25,136,  3, 10, 57,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3, 66, 60,  7,  3, 43, 23,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    8, 66,  7, 15,  3,  3,  3,  3,  3, 60,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  8, 38, 31, 40, 40, 53,  3,  8,  3,
+    3, 51, 18,  7, 17,  7, 17,  3,  3, 27, 27, 42,121, 27, 27, 27,
+   27, 27, 27, 27, 27, 27, 37, 88,  7, 64, 68,132, 63,137,  3,  3,
+    3, 12,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,138,  7,  7, 63,139,  3,  3,  3,  3,  3,
+   43,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 88,  7, 58, 98, 69,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  8, 63,  9, 65, 84, 17,  3,  3,  3,  3,  3,  3,
+    9,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 66,  7, 25, 98, 17,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  8,125,  7,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+  140, 18, 84,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3, 66,  7,  7, 45,  3, 27, 56, 48, 27, 27, 76, 27,
+   27, 27, 27, 27, 27, 31,141,142,143,144,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,138,  7, 18,
+   65, 17, 91,  3,  3,  3,  3,  3,  3, 77,  7,134, 27, 27, 27, 27,
+   27, 27, 27, 27, 27, 61,  7,145, 15,  3,130,  3,  3, 77, 25, 30,
+   27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 13,146,  7,  7, 25, 55,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3, 69, 58,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3, 59,  7, 15,  7, 84,  3,  3,  3,  3, 18,  7,  7,
+    7,  7,  7,147,  7, 69, 45,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3, 10, 15, 43, 11,  7, 24,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, 51,148,149, 98,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  8, 50,  3,  3,150, 27, 27, 27, 34, 27, 27,
+   27, 27, 27, 27, 27, 27, 63, 15, 51,151,  3,  3,  3,  3,  3, 43,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  0,  0,  0,  0, 17,  8,  7,  7,  7,  9,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+   18,  7,  7, 60, 30,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  7, 17,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  7, 15,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,152,152,128,  3,  3,  3,  3,  3,  3,  3,  3,  8,138, 65, 65,
+   65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,  3,  8, 15,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 17,  3,  3,  9,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+   12,  0,  3,  3,  3,  3,  3,  3,  3,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  9,  7,  7,  7,  7,  7, 15,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3, 10,  9, 10,153,  0,154,  7, 15, 10,  7,  3,  3,  3,  3,
+    3,  3,  3, 18,  9,  3,  3,  3,  3, 18, 17,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  7, 15,  8,  7,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7, 17,  3, 23,  3,  3,  3, 17,  3,  3,  3,  3,  8,
+    7, 10,  7,  7,  7,  3,  3,  3,  3,  7, 15,  7,  7,  7,  7, 20,
+    7, 11, 21, 15,  3,  3,  3,  3,  3,  3,  3,  3,  8,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3, 43,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  7,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3, 18,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  8, 43,  3, 18,  3, 23,  3,  3,  3,  3,  3,  3,  7, 15,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  7, 15,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,101,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,103,  3,  3,  3,  3,  3,  3,  3,  3,  3,103,103,
+  103,  3,  3,  3,107,101,  3,  3,  3,101,  3,  3,107,101,  3,  3,
+    3,  3,  3,  3,  3,  3,106,103,103,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,104,  3,  3,106,  3,  3,  3,102,108,103,109,
+    3,  3,  3,  3,106,103,103,103,103,103,103,103,103,103,103,103,
+  103,103,155,156,156,156,156,156,156,108,103,103,103,  3,  3,102,
+    3,  3,  3,  3,107,106,103,109,103,  3,  3,108,103,103,103,103,
+  103,  3,106,103,103,103,103,103,103,103,103,103,103,103,103,103,
+  103,103,103,103,103,103,103,103,103,103,103,103,103,103,103,103,
+  103,104,103,103,103,103,103,103,103,103,103,103,103,103,106,108,
+  106,103,103,103,103,103,103,103,103,103,103,103,103,103,103,103,
+  103,103,103,103,103,112,114,157,  7,103,103,103,103,103,103,103,
+  103,103,103,103,103,103,103,103,114,103,103,103,103,103,103,103,
+  103,103,103,103,103,103,103,103,104,  3,  3,108,109,103,103,103,
+  103,103,103,  3,107,112,103,109,  3,  3,107,106,104,101,105,  3,
+    3,  3,104,101,  3,105,  3,  3,101,106,101,  3,  3,108,  3,  3,
+  109,113,  3,101,107,107,  3,106,103,103,103,103,103,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,103,104,107,103,109,108,103,
+  103,103,104,113,103,112,103,103,103,  3,  3,  3,  3,  3,  3,106,
+  103,103,103,103,103,103,103,103,103,  3,  3,  3,103,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,103,103,  3,  3,106,
+  103,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,103,103,  3,  3,  3,
+    3,  3,  3,  3,106,  3,  3,  3,103,106,103,103,103,  3,  3,108,
+  103,103,103,103,103,103,103,103,103,  3,  3,  3,103,103,103,103,
+  103,103,103,103,103,103,103,109,103,103,114,103,103,103,103,103,
+  103,103,103,103,103,103,103,103,103,  3,  3,  3,  3,  3,  3,103,
+  103,  3,  3,  3,106,103,103,103,103,  0,  0,  0,  0,  0,  0,  0,
+    0,  7,  7,  7,  7,  7,  7,  7,  7,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  0,  0,  0,  0,  3,  3,  3,  3,  3,  3,  2,
+    3,  3,  1,  3,  3,  0,  0,  0,  0,  0,  0,  0,  3,  0, 14,  0,
+    0,  0,  3, 14,  0, 52, 52, 52, 52,  0,  0,  0, 52, 52, 52,  0,
+    0,  0, 52, 52, 52, 52, 52,  0, 52,  0, 52, 52,  0,  7,  7,  7,
+    7,  7,  7,  0,  0, 52, 52, 52,  0,  3,  0,  0,  0, 52,  0,  0,
+    0,  0,  0, 52, 52, 52,  7,  0, 52, 52,  0,  0, 52, 52,  0, 52,
+   52,  0,  0,  0,  7,  0, 52,  0,  0, 52, 52,  7, 52, 52, 52, 52,
+    8,  0, 16, 16, 16, 16, 16, 16, 16, 16, 16, 52,  8, 52,  0,  8,
+    8,  8, 52, 52, 52, 52,  8,  8,  8,  8, 36,  8,  8,  0, 52,  8,
+    8, 16,  0, 16, 16, 16,  0, 16,  0,  0,  0, 16, 16, 16, 16,  0,
+    0, 52,  0, 52,  8, 52,  0,  0,  8,  8,  0,  0,  8,  8, 36,  0,
+    0, 16, 16,  0, 16,  0,  0, 52,  0,  0, 52, 52,  8,  8, 52, 52,
+    0, 52,  8,  0,  8,  0, 16, 52, 52,  0, 16,  0,  0,  0,  0, 52,
+    8, 52,  8,  8,  0,  0,  0,  8,  8,  8,  0,  8,  8,  8, 52,  0,
+    0,  8,  0, 52, 52, 52, 36,  0,  0, 16, 16, 16,  0, 52,  0,  8,
+   52, 52,  8, 52,  8,  0,  0,  0,  8, 52, 52,  8,  8, 16, 16, 16,
+   52,  8, 36,  7,  0,  8,  8, 52, 52, 52,  0, 52,  0,  8,  8,  8,
+    8,  8,  8,  8, 52,  0, 52,  0,  8,  0, 52,  0, 52, 52,  8, 52,
+   52,  0, 36, 52,  8,  8, 52, 52, 16, 16, 16,  8,  8, 52, 52, 16,
+   16, 16, 16, 52, 52, 52, 16,  0,  0,  0, 16, 16,  0, 16, 52, 52,
+   52, 52, 16, 16, 16, 16, 16, 52,  0,  0, 52, 16,  0,  9,  9,  9,
+    9, 10, 10, 10, 10, 11, 11, 11, 11, 52, 52,  8, 52,  8,  8, 52,
+    8, 52, 52, 36, 52, 52, 52,  3, 52, 52,  8,  8, 52, 16,  8, 52,
+    8, 36,  0, 52,  0,  8,  0,  0,  0,  0,  0,  0, 16, 16,  0,  0,
+    0, 36, 16, 16, 16, 52, 52,  8, 16, 16,  8, 52, 52, 52, 52, 52,
+   36,  8, 52,  8, 52,  4, 53,  3,  3,  3,  3,  3,  0, 14,  0,  0,
+    0,  0,  0, 14,  0, 14, 14, 14, 14, 14, 14,  0,  0,  0, 14, 14,
+    0,  0,  0, 14, 14,  0,  0,  0, 14,  0, 14, 14, 14, 14, 14, 14,
+    0, 14,  0, 14, 14, 14,  0, 14,  0, 14,  0,  0, 14,  0, 14,  0,
+   14, 14, 14,  0, 14,  8, 52, 52,  8,  8,  8,  0,  0,  9,  0,  0,
+    0, 36,  0,  0,  0, 16, 52,  0, 16, 52,  8,  0,  0,  0,  0, 16,
+    0, 52,  0, 16, 16, 16, 16, 16,  8,  0,  8, 36,  0,  8, 52,  8,
+    8, 12, 13, 13, 13, 13, 13, 13, 13, 10, 10, 10,  0,  0,  0,  0,
+   11,  0,  0,  0, 36,  8, 52,  8,  0, 52, 52,  8,  0,  0,  7,  0,
+    0, 52, 52, 52, 16, 16,  8,  8, 16, 52,  0,  7,  7, 36,  7, 52,
+    0,  0,  8,  8,  8, 52,  8, 52,  0,  0, 52,  8, 52,  8,  8,  0,
+    8,  8,  0,  0, 52, 52, 52, 36,  7,  8,  7,  8, 52, 52,  8,  0,
+   52,  7,  7, 52, 52,  0,  8, 52, 52,  8,  8,  8,  0, 52, 52,  0,
+    8, 52, 52,  7,  8, 52, 52, 36,  0,  0,  0,  0, 10, 52, 52, 52,
+    3,  3,  3,  3, 52, 14, 14,  6,  6,  6,  6,  6,  6, 14, 14, 14,
+   52,
 };
 
-static inline uint8_t _raqm_b4 (const uint8_t* a, unsigned i)
-{
-  return (a[i>>1]>>((i&1)<<2))&15;
-}
-static inline uint8_t _raqm_get_grapheme_break (unsigned u)
+static inline uint8_t _raqm_get_grapheme_props (unsigned u)
 {
-  /* packtab: [2^4,2^4,2^3,2^2,2^2,2^2] */
-  return u<921600u ? (uint8_t)(_raqm_b4(_raqm_u8+2081u,((_raqm_u8[857u+_raqm_u16[((_raqm_u8[257u+((_raqm_u8[57u+((_raqm_b4(_raqm_u8,((((((((((u)>>2))>>2))>>2))>>3))>>4)))<<4)+((((((((((u)>>2))>>2))>>2))>>3))&15)])<<3)+((((((((u)>>2))>>2))>>2))&7)])<<2)+((((((u)>>2))>>2))&3)]+((((u)>>2))&3)])<<2)+((u)&3))) : 0;
+  /* packtab: [2^4,2^3,2^4,2^2] */
+  return u<925696u ? (uint8_t)(_raqm_u8[4665u+((_raqm_u8[921u+((_raqm_u8[321u+((_raqm_u8[113u+((_raqm_u8[(u)>>13])<<4)+((((u)>>9))&15)])<<3)+((((u)>>6))&7)])<<4)+((((u)>>2))&15)])<<2)+((u)&3)]) : 0;
 }
-static inline uint8_t _raqm_b2 (const uint8_t* a, unsigned i)
-{
-  return (a[i>>2]>>((i&3)<<1))&3;
-}
-static inline uint8_t _raqm_get_incb (unsigned u)
+
+#define RAQM_INCB_SHIFT 4
+#define RAQM_LATIN1_SCRIPT_LATIN 0x40
+
+static const uint8_t _raqm_latin1_props[256]=
 {
-  /* packtab: [2^4,2^4,2^3,2^2,2^4] */
-  return u<918000u ? (uint8_t)(_raqm_b2(_raqm_u8+3614u,((_raqm_u8[2958u+((_raqm_u8[2550u+((_raqm_u8[2370u+((_raqm_b4(_raqm_u8+2313u,((((((((u)>>4))>>2))>>3))>>4)))<<4)+((((((((u)>>4))>>2))>>3))&15)])<<3)+((((((u)>>4))>>2))&7)])<<2)+((((u)>>4))&3)])<<4)+((u)&15))) : 0;
-}
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  2,  3,  3,  1,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+   64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,  0,  0,  0,  0,  0,
+    0, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+   64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,  0,  0,  0,  0,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    0,  0,  0,  0,  0,  0,  0,  0,  0, 14, 64,  0,  0,  3, 14,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 64,  0,  0,  0,  0,  0,
+   64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+   64, 64, 64, 64, 64, 64, 64,  0, 64, 64, 64, 64, 64, 64, 64, 64,
+   64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+   64, 64, 64, 64, 64, 64, 64,  0, 64, 64, 64, 64, 64, 64, 64, 64,
+};
 
 #endif /* _RAQM_GRAPHEME_DATA_H_ */
@@ -27,8 +27,30 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Vector instructions that every CPU of the target architecture has, so
+ * that no runtime detection is needed. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAQM_SSE2 1
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define RAQM_NEON 1
+#endif
+
 #ifdef RAQM_SHEENBIDI
 #ifdef RAQM_SHEENBIDI_GT_2_9
 #include <SheenBidi/SheenBidi.h>
@@ -41,6 +63,14 @@
 
 #include <hb.h>
 #include <hb-ft.h>
+#include <hb-ot.h>
+
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+
+#if !HB_VERSION_ATLEAST (10, 4, 0)
+# define hb_ft_font_get_ft_face hb_ft_font_get_face
+#endif
 
 #include "raqm.h"
 #include "grapheme-data.h"
@@ -174,28 +204,240 @@
   typedef FriBidiLevel _raqm_bidi_level_t;
 #endif
 
+/* The attributes set on a range of the text. Spans are kept sorted, cover
+ * the whole text and adjacent ones always differ. */
+typedef struct
+{
+  size_t        start;
+  FT_Face       ftface;
+  int           ftloadflags;
+  hb_language_t lang;
+  int           spacing_after;
+} _raqm_text_span;
+
+#define RAQM_SPAN_FTFACE        (1 << 0)
+#define RAQM_SPAN_FTLOADFLAGS   (1 << 1)
+#define RAQM_SPAN_LANG          (1 << 2)
+#define RAQM_SPAN_SPACING_AFTER (1 << 3)
+
+/* The memory allocation functions of a raqm_t, see
+ * raqm_create_with_allocator() */
+typedef struct
+{
+  raqm_malloc_func_t  malloc_func;
+  raqm_realloc_func_t realloc_func;
+  raqm_free_func_t    free_func;
+  void               *user_data;
+} _raqm_allocator;
+
+/* Number of entries in each of the per-font glyph caches, a power of 2 */
+#define RAQM_GLYPH_CACHE_SIZE 256
+
+#define RAQM_GLYPH_CACHE_EMPTY ((hb_codepoint_t) -1)
+
+typedef struct
+{
+  hb_codepoint_t key;
+  uint32_t       value;
+} _raqm_glyph_cache_slot;
+
+/* Direct-mapped caches of the nominal glyphs and advances of a font, used as
+ * its font functions in front of the hb-ft ones. */
+typedef struct
+{
+  _raqm_glyph_cache_slot nominal_glyphs[RAQM_GLYPH_CACHE_SIZE];
+  _raqm_glyph_cache_slot h_advances[RAQM_GLYPH_CACHE_SIZE];
+
+  /* For freeing the cache from the destroy callback of the font */
+  _raqm_allocator        allocator;
+} _raqm_glyph_cache;
+
 typedef struct
 {
   FT_Face       ftface;
   int           ftloadflags;
+  FT_Size       ftsize;
+  FT_Fixed      x_scale;
+  FT_Fixed      y_scale;
+  raqm_font_funcs_t funcs;
+  hb_font_t    *font;
+  _raqm_glyph_cache *glyphs;
+  uint64_t      fingerprint;
+  bool          has_fingerprint;
+} _raqm_font_cache_entry;
+
+/* Maximum number of HarfBuzz fonts kept alive per raqm_t */
+#define RAQM_FONT_CACHE_SIZE 16
+
+typedef struct
+{
+  hb_font_t        *font;
+  int               x_scale;
+  int               y_scale;
+  hb_script_t       script;
+  hb_language_t     lang;
+  hb_direction_t    direction;
+  hb_buffer_flags_t flags;
+  int               invisible_glyph;
+  const uint32_t   *text;
+  size_t            text_len;
+  const hb_feature_t *features;
+  size_t            features_len;
+  uint32_t          hash;
+} _raqm_word_key;
+
+/* A hash table of entries kept in most recently used order, bound by the
+ * number of entries and optionally their total size in bytes. Entries embed
+ * _raqm_cache_entry as their first member. */
+typedef struct _raqm_cache_entry _raqm_cache_entry;
+
+struct _raqm_cache_entry
+{
+  uint32_t           hash;
+  size_t             size;
+
+  _raqm_cache_entry *bucket_next;
+  _raqm_cache_entry *prev;
+  _raqm_cache_entry *next;
+};
+
+typedef struct
+{
+  _raqm_cache_entry **buckets;
+  size_t              buckets_len;
+  _raqm_cache_entry  *head;
+  _raqm_cache_entry  *tail;
+  size_t              len;
+  size_t              max_len;
+  size_t              size;
+  size_t              max_size;
+  size_t              hits;
+  size_t              misses;
+  const _raqm_allocator *allocator;
+  void              (*destroy) (const _raqm_allocator *allocator,
+                                _raqm_cache_entry     *entry);
+} _raqm_cache;
+
+typedef struct
+{
+  _raqm_cache_entry    base;
+  _raqm_word_key       key;
+  hb_glyph_info_t     *info;
+  hb_glyph_position_t *pos;
+  unsigned int         len;
+} _raqm_word_entry;
+
+/* Words longer than this are always shaped directly */
+#define RAQM_WORD_CACHE_MAX_WORD_LEN 64
+
+typedef struct
+{
+  const unsigned char *data;
+  size_t               len;
+} _raqm_layout_key;
+
+/* A span of characters with the same attributes, as serialized in the
+ * layout cache key. */
+typedef struct
+{
+  size_t        len;
+  FT_Face       ftface;
   hb_language_t lang;
-  hb_script_t   script;
+  int           ftloadflags;
   int           spacing_after;
-} _raqm_text_info;
+  FT_Fixed      x_scale;
+  FT_Fixed      y_scale;
+  FT_Matrix     matrix;
+} _raqm_layout_span;
+
+typedef struct
+{
+  uint32_t       pos;
+  uint32_t       len;
+  hb_direction_t direction;
+  hb_script_t    script;
+  unsigned int   glyphs_len;
+} _raqm_layout_run;
+
+typedef struct
+{
+  _raqm_cache_entry    base;
+  _raqm_layout_key     key;
+  raqm_direction_t     resolved_dir;
+  _raqm_layout_run    *runs;
+  size_t               runs_len;
+  raqm_glyph_t        *glyphs;
+  FT_Face             *faces;
+  size_t               faces_len;
+} _raqm_layout_entry;
+
+typedef struct
+{
+  hb_face_t              *face;
+  hb_segment_properties_t props;
+  hb_feature_t           *features;
+  size_t                  features_len;
+  hb_shape_plan_t        *plan;
+} _raqm_shape_plan_entry;
+
+/* Maximum number of shape plans kept alive per raqm_t */
+#define RAQM_SHAPE_PLAN_CACHE_SIZE 32
+
+/* Memory for temporary arrays needed during raqm_layout(), handed out from
+ * blocks that are only released by raqm_clear_contents(). */
+typedef struct _raqm_arena_block _raqm_arena_block;
+
+struct _raqm_arena_block
+{
+  _raqm_arena_block *prev;
+  size_t             size;
+  size_t             used;
+};
+
+#define RAQM_ARENA_ALIGN 16
+#define RAQM_ARENA_MIN_BLOCK_SIZE 4096
+
+/* Size of the block header, rounded so that the data after it is aligned */
+#define RAQM_ARENA_HEADER_SIZE \
+  ((sizeof (_raqm_arena_block) + RAQM_ARENA_ALIGN - 1) & ~(size_t) (RAQM_ARENA_ALIGN - 1))
+
+/* For UTF-8 and UTF-16 text, the offset of every this many codepoints in the
+ * original string is kept to convert indices between encodings. */
+#define RAQM_TEXT_OFFSETS_STEP 64
 
 typedef struct _raqm_run raqm_run_t;
 
+/* A run, by the index of its first character, in the logical order index */
+typedef struct
+{
+  size_t pos;
+  size_t run;
+} _raqm_run_index;
+
 struct _raqm
 {
   int              ref_count;
 
-  uint32_t        *text;
-  uint16_t        *text_utf16;
-  char            *text_utf8;
+  _raqm_allocator  allocator;
+
+  const uint32_t  *text;
+  const uint16_t  *text_utf16;
+  const char      *text_utf8;
+  size_t          *text_offsets;
+  size_t           text_encoded_len;
   size_t           text_len;
+  void            *text_memory;
   size_t           text_capacity_bytes;
 
-  _raqm_text_info *text_info;
+  _raqm_text_span *spans;
+  size_t           spans_len;
+  size_t           spans_capacity;
+
+  uint32_t        *grapheme_breaks;
+  size_t           grapheme_breaks_capacity;
+  bool             grapheme_breaks_valid;
+
+  hb_script_t     *scripts;
 
   raqm_direction_t base_dir;
   raqm_direction_t resolved_dir;
@@ -204,12 +446,37 @@ struct _raqm
   size_t           features_len;
 
   raqm_run_t      *runs;
-  raqm_run_t      *runs_pool;
+  size_t           runs_len;
+  size_t           runs_capacity;
+  _raqm_run_index *runs_logical;
 
+  _raqm_arena_block *arena;
+
+  hb_buffer_t     *shape_buffer;
   raqm_glyph_t    *glyphs;
+  uint32_t        *glyph_clusters;
+  size_t           glyphs_len;
   size_t           glyphs_capacity;
 
+  _raqm_font_cache_entry fonts[RAQM_FONT_CACHE_SIZE];
+  size_t           fonts_len;
+  size_t           fonts_max_kept;
+
+  _raqm_cache      word_cache;
+  const unsigned char *word_file;
+  size_t           word_file_size;
+  bool             word_file_mapped;
+
+  _raqm_cache      layout_cache;
+  unsigned char   *layout_key;
+  size_t           layout_key_len;
+  size_t           layout_key_capacity;
+
+  _raqm_shape_plan_entry plans[RAQM_SHAPE_PLAN_CACHE_SIZE];
+  size_t           plans_len;
+
   int              invisible_glyph;
+  raqm_font_funcs_t font_funcs;
 };
 
 struct _raqm_run
@@ -220,59 +487,283 @@ struct _raqm_run
   hb_direction_t direction;
   hb_script_t    script;
   hb_font_t     *font;
-  hb_buffer_t   *buffer;
 
-  raqm_run_t    *next;
+  size_t         glyphs_start;
+  size_t         glyphs_len;
 };
 
 static size_t
 _raqm_encoding_to_u32_index (raqm_t *rq,
                              size_t  index);
 
+static size_t
+_raqm_u32_to_encoding_index (raqm_t *rq,
+                             size_t  index);
+
+static void *
+_raqm_default_malloc (size_t  size,
+                      void   *user_data)
+{
+  return malloc (size);
+}
+
+static void *
+_raqm_default_realloc (void   *ptr,
+                       size_t  size,
+                       void   *user_data)
+{
+  return realloc (ptr, size);
+}
+
 static void
-_raqm_init_text_info (raqm_t *rq)
+_raqm_default_free (void *ptr,
+                    void *user_data)
 {
-  hb_language_t default_lang = hb_language_get_default ();
-  for (size_t i = 0; i < rq->text_len; i++)
+  free (ptr);
+}
+
+static void *
+_raqm_malloc (const _raqm_allocator *allocator,
+              size_t                 size)
+{
+  return allocator->malloc_func (size, allocator->user_data);
+}
+
+static void *
+_raqm_calloc (const _raqm_allocator *allocator,
+              size_t                 count,
+              size_t                 size)
+{
+  void *p;
+
+  if (size && count > SIZE_MAX / size)
+    return NULL;
+
+  p = _raqm_malloc (allocator, count * size);
+  if (p)
+    memset (p, 0, count * size);
+
+  return p;
+}
+
+static void *
+_raqm_realloc (const _raqm_allocator *allocator,
+               void                  *ptr,
+               size_t                 size)
+{
+  return allocator->realloc_func (ptr, size, allocator->user_data);
+}
+
+static void
+_raqm_free (const _raqm_allocator *allocator,
+            void                  *ptr)
+{
+  if (ptr)
+    allocator->free_func (ptr, allocator->user_data);
+}
+
+static bool
+_raqm_reserve_spans (raqm_t *rq,
+                     size_t  len)
+{
+  _raqm_text_span *spans;
+  size_t capacity;
+
+  if (len <= rq->spans_capacity)
+    return true;
+
+  capacity = rq->spans_capacity ? rq->spans_capacity : 8;
+  while (capacity < len)
+    capacity *= 2;
+
+  spans = _raqm_realloc (&rq->allocator, rq->spans,
+                         sizeof (_raqm_text_span) * capacity);
+  if (!spans)
+    return false;
+
+  rq->spans = spans;
+  rq->spans_capacity = capacity;
+
+  return true;
+}
+
+/* Sets a single span with the default attributes over the whole text */
+static bool
+_raqm_init_spans (raqm_t *rq)
+{
+  if (!_raqm_reserve_spans (rq, 1))
+    return false;
+
+  rq->spans[0].start = 0;
+  rq->spans[0].ftface = NULL;
+  rq->spans[0].ftloadflags = -1;
+  rq->spans[0].lang = hb_language_get_default ();
+  rq->spans[0].spacing_after = 0;
+  rq->spans_len = 1;
+
+  return true;
+}
+
+static void
+_raqm_release_spans (raqm_t *rq)
+{
+  for (size_t i = 0; i < rq->spans_len; i++)
   {
-    rq->text_info[i].ftface = NULL;
-    rq->text_info[i].ftloadflags = -1;
-    rq->text_info[i].lang = default_lang;
-    rq->text_info[i].script = HB_SCRIPT_INVALID;
-    rq->text_info[i].spacing_after = 0;
+    if (rq->spans[i].ftface)
+      FT_Done_Face (rq->spans[i].ftface);
   }
+
+  rq->spans_len = 0;
 }
 
-static void
-_raqm_release_text_info (raqm_t *rq)
+static size_t
+_raqm_span_end (raqm_t *rq,
+                size_t  span)
 {
-  if (!rq->text_info)
-    return;
+  return span + 1 < rq->spans_len ? rq->spans[span + 1].start : rq->text_len;
+}
 
-  for (size_t i = 0; i < rq->text_len; i++)
+/* Returns the index of the span containing the character at @index. @hint
+ * is a span to try first, usually the one found for a nearby character. */
+static size_t
+_raqm_find_span (raqm_t *rq,
+                 size_t  index,
+                 size_t  hint)
+{
+  size_t lo = 0, hi = rq->spans_len;
+
+  if (hint < rq->spans_len && rq->spans[hint].start <= index)
+  {
+    if (index < _raqm_span_end (rq, hint))
+      return hint;
+    if (hint + 1 < rq->spans_len && index < _raqm_span_end (rq, hint + 1))
+      return hint + 1;
+  }
+  else if (hint && hint - 1 < rq->spans_len &&
+           rq->spans[hint - 1].start <= index)
+    return hint - 1;
+
+  /* The last span starting at or before @index */
+  while (hi - lo > 1)
   {
-    if (rq->text_info[i].ftface)
-      FT_Done_Face (rq->text_info[i].ftface);
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (rq->spans[mid].start <= index)
+      lo = mid;
+    else
+      hi = mid;
   }
+
+  return lo;
+}
+
+/* Makes a span start at @index, and returns it. */
+static size_t
+_raqm_split_span (raqm_t *rq,
+                  size_t  index)
+{
+  size_t i;
+
+  if (index >= rq->text_len)
+    return rq->spans_len;
+
+  i = _raqm_find_span (rq, index, 0);
+  if (rq->spans[i].start == index)
+    return i;
+
+  memmove (rq->spans + i + 2, rq->spans + i + 1,
+           sizeof (_raqm_text_span) * (rq->spans_len - i - 1));
+  rq->spans[i + 1] = rq->spans[i];
+  rq->spans[i + 1].start = index;
+  rq->spans_len++;
+
+  if (rq->spans[i + 1].ftface)
+    FT_Reference_Face (rq->spans[i + 1].ftface);
+
+  return i + 1;
 }
 
 static bool
-_raqm_compare_text_info (_raqm_text_info a,
-                         _raqm_text_info b)
+_raqm_span_equal (const _raqm_text_span *a,
+                  const _raqm_text_span *b)
 {
-  if (a.ftface != b.ftface)
-    return false;
+  return a->ftface == b->ftface &&
+         a->ftloadflags == b->ftloadflags &&
+         a->lang == b->lang &&
+         a->spacing_after == b->spacing_after;
+}
 
-  if (a.ftloadflags != b.ftloadflags)
-    return false;
+/* Whether characters in @a and @b can be shaped in the same run */
+static bool
+_raqm_span_same_font (const _raqm_text_span *a,
+                      const _raqm_text_span *b)
+{
+  /* Spacing shouldn't break runs, so we don't compare them here. */
+  return a->ftface == b->ftface &&
+         a->ftloadflags == b->ftloadflags &&
+         a->lang == b->lang;
+}
 
-  if (a.lang != b.lang)
-    return false;
+/* Sets the attributes of @attrs selected by @mask on the characters from
+ * @start to @end, splitting and merging spans as needed. */
+static bool
+_raqm_set_spans (raqm_t                *rq,
+                 size_t                 start,
+                 size_t                 end,
+                 const _raqm_text_span *attrs,
+                 unsigned int           mask)
+{
+  size_t first, last, merge_start, merge_end, out;
 
-  if (a.script != b.script)
+  if (start >= end)
+    return true;
+
+  /* Splitting adds at most two spans, make sure it cannot fail halfway */
+  if (!_raqm_reserve_spans (rq, rq->spans_len + 2))
     return false;
 
-  /* Spacing shouldn't break runs, so we don't compare them here. */
+  first = _raqm_split_span (rq, start);
+  last = _raqm_split_span (rq, end);
+
+  for (size_t i = first; i < last; i++)
+  {
+    _raqm_text_span *span = &rq->spans[i];
+
+    if (mask & RAQM_SPAN_FTFACE && span->ftface != attrs->ftface)
+    {
+      if (span->ftface)
+        FT_Done_Face (span->ftface);
+      span->ftface = attrs->ftface;
+      if (span->ftface)
+        FT_Reference_Face (span->ftface);
+    }
+    if (mask & RAQM_SPAN_FTLOADFLAGS)
+      span->ftloadflags = attrs->ftloadflags;
+    if (mask & RAQM_SPAN_LANG)
+      span->lang = attrs->lang;
+    if (mask & RAQM_SPAN_SPACING_AFTER)
+      span->spacing_after = attrs->spacing_after;
+  }
+
+  /* Merge the changed spans with each other and with their neighbors */
+  merge_start = first ? first - 1 : first;
+  merge_end = last < rq->spans_len ? last + 1 : last;
+
+  out = merge_start;
+  for (size_t i = merge_start + 1; i < merge_end; i++)
+  {
+    if (_raqm_span_equal (&rq->spans[out], &rq->spans[i]))
+    {
+      if (rq->spans[i].ftface)
+        FT_Done_Face (rq->spans[i].ftface);
+    }
+    else
+      rq->spans[++out] = rq->spans[i];
+  }
+
+  memmove (rq->spans + out + 1, rq->spans + merge_end,
+           sizeof (_raqm_text_span) * (rq->spans_len - merge_end));
+  rq->spans_len -= merge_end - out - 1;
 
   return true;
 }
@@ -280,137 +771,1401 @@ _raqm_compare_text_info (_raqm_text_info a,
 static void
 _raqm_free_text(raqm_t* rq)
 {
-  free (rq->text);
+  _raqm_free (&rq->allocator, rq->text_memory);
+  rq->text_memory = NULL;
   rq->text = NULL;
-  rq->text_info = NULL;
+  rq->scripts = NULL;
   rq->text_utf8 = NULL;
   rq->text_utf16 = NULL;
+  rq->text_offsets = NULL;
+  rq->text_encoded_len = 0;
   rq->text_len = 0;
   rq->text_capacity_bytes = 0;
 }
 
-static bool
-_raqm_alloc_text(raqm_t *rq,
-                 size_t  len,
-                 bool    need_utf8,
-                 bool    need_utf16)
-{
-  /* Allocate contiguous memory block for texts and text_info */
-  size_t mem_size = (sizeof (uint32_t) + sizeof (_raqm_text_info)) * len;
-  if (need_utf8)
+/* Allocates the memory for a text of at most @len codepoints. Unless
+ * @borrowed, the text will be copied there, so for UTF-8 and UTF-16 input
+ * there is room for both the UTF-32 text and the original one. Borrowed
+ * UTF-32 text needs no copy at all, other borrowed text only its UTF-32
+ * version. Returns the memory for the UTF-32 text, or for the UTF-8 or
+ * UTF-16 copy in @encoded. */
+static uint32_t *
+_raqm_alloc_text(raqm_t  *rq,
+                 size_t   len,
+                 bool     need_utf8,
+                 bool     need_utf16,
+                 bool     borrowed,
+                 void   **encoded)
+{
+  /* Allocate contiguous memory block for texts and scripts, and the offsets
+   * for other encodings. The text has at most @len codepoints. */
+  bool need_text = !borrowed || need_utf8 || need_utf16;
+  size_t offsets_len = 0;
+  size_t mem_size = sizeof (hb_script_t) * len;
+  uint32_t *text;
+  if (need_text)
+    mem_size += sizeof (uint32_t) * len;
+  if (need_utf8 || need_utf16)
+    offsets_len = len / RAQM_TEXT_OFFSETS_STEP + 1;
+  mem_size += sizeof (size_t) * offsets_len;
+  if (need_utf8 && !borrowed)
     mem_size += sizeof (char) * len;
-  else if (need_utf16)
+  else if (need_utf16 && !borrowed)
     mem_size += sizeof (uint16_t) * len;
 
   if (mem_size > rq->text_capacity_bytes)
   {
-    void* new_mem = realloc (rq->text, mem_size);
+    void* new_mem = _raqm_realloc (&rq->allocator, rq->text_memory, mem_size);
     if (!new_mem)
     {
       _raqm_free_text (rq);
-      return false;
+      return NULL;
     }
 
     rq->text_capacity_bytes = mem_size;
-    rq->text = new_mem;
+    rq->text_memory = new_mem;
   }
 
-  rq->text_info = (_raqm_text_info*)(rq->text + len);
-  rq->text_utf8 = need_utf8 ? (char*)(rq->text_info + len) : NULL;
-  rq->text_utf16 = need_utf16 ? (uint16_t*)(rq->text_info + len) : NULL;
+  text = rq->text_memory;
+  rq->scripts = (hb_script_t*)(need_text ? text + len : text);
+  rq->text_offsets = offsets_len ? (size_t*)(rq->scripts + len) : NULL;
+  rq->text = NULL;
+  rq->text_utf8 = NULL;
+  rq->text_utf16 = NULL;
+  if (encoded)
+    *encoded = rq->text_offsets + offsets_len;
+
+  return text;
+}
 
-  return true;
+static _raqm_arena_block *
+_raqm_arena_new_block (const _raqm_allocator *allocator,
+                       _raqm_arena_block     *prev,
+                       size_t                 size)
+{
+  _raqm_arena_block *block = _raqm_malloc (allocator,
+                                           RAQM_ARENA_HEADER_SIZE + size);
+  if (!block)
+    return NULL;
+
+  block->prev = prev;
+  block->size = size;
+  block->used = 0;
+
+  return block;
 }
 
-static raqm_run_t*
-_raqm_alloc_run (raqm_t *rq)
+/* Returns @size bytes of uninitialized memory that stays valid until the
+ * arena is reset. There is no need to free it. */
+static void *
+_raqm_arena_alloc (raqm_t *rq,
+                   size_t  size)
 {
-  raqm_run_t *run = rq->runs_pool;
-  if (run)
-  {
-    rq->runs_pool = run->next;
-  }
-  else
+  _raqm_arena_block *block = rq->arena;
+  void *p;
+
+  size = (size + RAQM_ARENA_ALIGN - 1) & ~(size_t) (RAQM_ARENA_ALIGN - 1);
+  if (!size)
+    size = RAQM_ARENA_ALIGN;
+
+  if (!block || block->size - block->used < size)
   {
-    run = malloc (sizeof (raqm_run_t));
-    if (!run)
+    size_t block_size = block ? block->size * 2 : RAQM_ARENA_MIN_BLOCK_SIZE;
+
+    if (block_size < size)
+      block_size = size;
+
+    block = _raqm_arena_new_block (&rq->allocator, block, block_size);
+    if (!block)
       return NULL;
-    run->font = NULL;
-    run->buffer = NULL;
+
+    rq->arena = block;
   }
 
-  run->pos = 0;
-  run->len = 0;
-  run->direction = HB_DIRECTION_INVALID;
-  run->script = HB_SCRIPT_INVALID;
-  run->next = NULL;
+  p = (char *) block + RAQM_ARENA_HEADER_SIZE + block->used;
+  block->used += size;
 
-  return run;
+  return p;
 }
 
 static void
-_raqm_free_runs (raqm_run_t *runs)
+_raqm_arena_free (raqm_t *rq)
 {
-  while (runs)
+  while (rq->arena)
   {
-    raqm_run_t *run = runs;
-    runs = runs->next;
+    _raqm_arena_block *prev = rq->arena->prev;
+    _raqm_free (&rq->allocator, rq->arena);
+    rq->arena = prev;
+  }
+}
 
-    if (run->buffer)
-      hb_buffer_destroy (run->buffer);
+/* Makes all the arena memory available again. If the last layout needed
+ * more than one block, they are replaced by a single one as large as all of
+ * them, so that laying out similar text again does not allocate. */
+static void
+_raqm_arena_reset (raqm_t *rq)
+{
+  size_t size = 0;
 
-    if (run->font)
-      hb_font_destroy (run->font);
+  if (!rq->arena)
+    return;
 
-    free (run);
+  if (!rq->arena->prev)
+  {
+    rq->arena->used = 0;
+    return;
   }
+
+  for (_raqm_arena_block *block = rq->arena; block; block = block->prev)
+    size += block->size;
+
+  _raqm_arena_free (rq);
+  rq->arena = _raqm_arena_new_block (&rq->allocator, NULL, size);
 }
 
-/**
- * raqm_create:
- *
- * Creates a new #raqm_t with all its internal states initialized to their
- * defaults.
- *
- * Return value:
- * A newly allocated #raqm_t with a reference count of 1. The initial reference
- * count should be released with raqm_destroy() when you are done using the
- * #raqm_t. Returns `NULL` in case of error.
- *
- * Since: 0.1
- */
-raqm_t *
-raqm_create (void)
+/* Appends a run to rq->runs, growing it as needed. The returned pointer is
+ * only valid until the next run is added. */
+static raqm_run_t*
+_raqm_add_run (raqm_t *rq)
 {
-  raqm_t *rq;
-
-  rq = malloc (sizeof (raqm_t));
-  if (!rq)
-    return NULL;
+  raqm_run_t *run;
 
-  rq->ref_count = 1;
+  if (rq->runs_len == rq->runs_capacity)
+  {
+    size_t capacity = rq->runs_capacity ? rq->runs_capacity * 2 : 8;
+    raqm_run_t *runs;
 
-  rq->base_dir = RAQM_DIRECTION_DEFAULT;
-  rq->resolved_dir = RAQM_DIRECTION_DEFAULT;
+    if (capacity > SIZE_MAX / sizeof (raqm_run_t))
+      return NULL;
 
-  rq->features = NULL;
-  rq->features_len = 0;
+    runs = _raqm_realloc (&rq->allocator, rq->runs,
+                          sizeof (raqm_run_t) * capacity);
+    if (!runs)
+      return NULL;
 
-  rq->invisible_glyph = 0;
+    rq->runs = runs;
+    rq->runs_capacity = capacity;
+  }
 
-  rq->text = NULL;
-  rq->text_utf16 = NULL;
+  run = &rq->runs[rq->runs_len++];
+  run->pos = 0;
+  run->len = 0;
+  run->direction = HB_DIRECTION_INVALID;
+  run->script = HB_SCRIPT_INVALID;
+  run->font = NULL;
+  run->glyphs_start = rq->glyphs_len;
+  run->glyphs_len = 0;
+
+  return run;
+}
+
+/* Drops the runs and the glyphs of the last layout */
+static void
+_raqm_reset_runs (raqm_t *rq)
+{
+  for (size_t i = 0; i < rq->runs_len; i++)
+    hb_font_destroy (rq->runs[i].font);
+
+  rq->runs_len = 0;
+  rq->runs_logical = NULL;
+  rq->glyphs_len = 0;
+}
+
+static void
+_raqm_free_runs (raqm_t *rq)
+{
+  _raqm_reset_runs (rq);
+  _raqm_free (&rq->allocator, rq->runs);
+}
+
+static int
+_raqm_run_index_compare (const void *a,
+                         const void *b)
+{
+  const _raqm_run_index *ia = a, *ib = b;
+
+  return ia->pos < ib->pos ? -1 : ia->pos > ib->pos;
+}
+
+/* Called once the runs are shaped, indexes them in logical order. */
+static bool
+_raqm_index_runs (raqm_t *rq)
+{
+  rq->runs_logical = _raqm_arena_alloc (rq, sizeof (_raqm_run_index) *
+                                            rq->runs_len);
+  if (!rq->runs_logical)
+    return false;
+
+  for (size_t i = 0; i < rq->runs_len; i++)
+  {
+    rq->runs_logical[i].pos = rq->runs[i].pos;
+    rq->runs_logical[i].run = i;
+  }
+
+  qsort (rq->runs_logical, rq->runs_len, sizeof (_raqm_run_index),
+         _raqm_run_index_compare);
+
+  return true;
+}
+
+/* Returns the run containing the character at @index, or `NULL` */
+static const raqm_run_t *
+_raqm_find_run (raqm_t *rq,
+                size_t  index)
+{
+  size_t lo = 0, hi = rq->runs_len;
+
+  if (!rq->runs_logical)
+    return NULL;
+
+  /* The last run starting at or before @index */
+  while (hi - lo > 1)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (rq->runs_logical[mid].pos <= index)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  if (lo < rq->runs_len)
+  {
+    const raqm_run_t *run = &rq->runs[rq->runs_logical[lo].run];
+
+    if (run->pos <= index && index < run->pos + run->len)
+      return run;
+  }
+
+  return NULL;
+}
+
+/* Makes room for @len glyphs in the glyph store */
+static bool
+_raqm_reserve_glyphs (raqm_t *rq,
+                      size_t  len)
+{
+  size_t capacity = rq->glyphs_capacity ? rq->glyphs_capacity : 64;
+  void *new_mem;
+
+  if (len <= rq->glyphs_capacity)
+    return true;
+
+  while (capacity < len)
+  {
+    if (capacity > SIZE_MAX / 2 / sizeof (raqm_glyph_t))
+      return false;
+    capacity *= 2;
+  }
+
+  new_mem = _raqm_realloc (&rq->allocator, rq->glyphs,
+                           sizeof (raqm_glyph_t) * capacity);
+  if (!new_mem)
+    return false;
+  rq->glyphs = new_mem;
+
+  new_mem = _raqm_realloc (&rq->allocator, rq->glyph_clusters,
+                           sizeof (uint32_t) * capacity);
+  if (!new_mem)
+    return false;
+  rq->glyph_clusters = new_mem;
+
+  rq->glyphs_capacity = capacity;
+  return true;
+}
+
+/* Appends the glyphs in @buffer to those of @run, which must be the last one
+ * in the glyph store. */
+static bool
+_raqm_append_glyphs (raqm_t      *rq,
+                     raqm_run_t  *run,
+                     hb_buffer_t *buffer)
+{
+  unsigned int len;
+  hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &len);
+  hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buffer, NULL);
+  /* Runs never cross face changes */
+  FT_Face ftface = rq->spans[_raqm_find_span (rq, run->pos, 0)].ftface;
+  raqm_glyph_t *glyphs;
+  uint32_t *clusters;
+
+  if (!_raqm_reserve_glyphs (rq, rq->glyphs_len + len))
+    return false;
+
+  glyphs = rq->glyphs + rq->glyphs_len;
+  clusters = rq->glyph_clusters + rq->glyphs_len;
+  for (unsigned int i = 0; i < len; i++)
+  {
+    glyphs[i].index = info[i].codepoint;
+    glyphs[i].x_advance = pos[i].x_advance;
+    glyphs[i].y_advance = pos[i].y_advance;
+    glyphs[i].x_offset = pos[i].x_offset;
+    glyphs[i].y_offset = pos[i].y_offset;
+    glyphs[i].cluster = info[i].cluster;
+    glyphs[i].ftface = ftface;
+    clusters[i] = info[i].cluster;
+  }
+
+  rq->glyphs_len += len;
+  run->glyphs_len += len;
+  return true;
+}
+
+static void
+_raqm_free_fonts (raqm_t *rq)
+{
+  for (size_t i = 0; i < rq->fonts_len; i++)
+    hb_font_destroy (rq->fonts[i].font);
+
+  rq->fonts_len = 0;
+}
+
+static void
+_raqm_free_shape_plan_entry (raqm_t                 *rq,
+                             _raqm_shape_plan_entry *entry)
+{
+  hb_shape_plan_destroy (entry->plan);
+  hb_face_destroy (entry->face);
+  _raqm_free (&rq->allocator, entry->features);
+}
+
+static void
+_raqm_free_shape_plans (raqm_t *rq)
+{
+  for (size_t i = 0; i < rq->plans_len; i++)
+    _raqm_free_shape_plan_entry (rq, &rq->plans[i]);
+
+  rq->plans_len = 0;
+}
+
+/* Drops the least recently used fonts until at most @max_len are left,
+ * along with the shape plans of their faces, so that nothing references
+ * their FT_Face anymore. */
+static void
+_raqm_trim_fonts (raqm_t *rq,
+                  size_t  max_len)
+{
+  while (rq->fonts_len > max_len)
+  {
+    hb_font_t *font = rq->fonts[--rq->fonts_len].font;
+    hb_face_t *face = hb_font_get_face (font);
+    size_t kept = 0;
+
+    for (size_t i = 0; i < rq->plans_len; i++)
+    {
+      if (rq->plans[i].face == face)
+        _raqm_free_shape_plan_entry (rq, &rq->plans[i]);
+      else
+        rq->plans[kept++] = rq->plans[i];
+    }
+    rq->plans_len = kept;
+
+    hb_font_destroy (font);
+  }
+}
+
+/* FNV-1a */
+#define RAQM_HASH_INIT 2166136261u
+
+static uint32_t
+_raqm_hash (uint32_t    hash,
+            const void *data,
+            size_t      len)
+{
+  const unsigned char *p = data;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= p[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static uint32_t
+_raqm_word_key_hash (const _raqm_word_key *key)
+{
+  uint32_t hash = RAQM_HASH_INIT;
+
+  hash = _raqm_hash (hash, &key->font, sizeof (key->font));
+  hash = _raqm_hash (hash, &key->x_scale, sizeof (key->x_scale));
+  hash = _raqm_hash (hash, &key->y_scale, sizeof (key->y_scale));
+  hash = _raqm_hash (hash, &key->script, sizeof (key->script));
+  hash = _raqm_hash (hash, &key->lang, sizeof (key->lang));
+  hash = _raqm_hash (hash, &key->direction, sizeof (key->direction));
+  hash = _raqm_hash (hash, &key->flags, sizeof (key->flags));
+  hash = _raqm_hash (hash, &key->invisible_glyph, sizeof (key->invisible_glyph));
+  hash = _raqm_hash (hash, key->text, sizeof (uint32_t) * key->text_len);
+  hash = _raqm_hash (hash, key->features,
+                     sizeof (hb_feature_t) * key->features_len);
+
+  return hash;
+}
+
+static bool
+_raqm_word_key_equal (const _raqm_word_key *a,
+                      const _raqm_word_key *b)
+{
+  return a->hash == b->hash &&
+         a->font == b->font &&
+         a->x_scale == b->x_scale &&
+         a->y_scale == b->y_scale &&
+         a->script == b->script &&
+         a->lang == b->lang &&
+         a->direction == b->direction &&
+         a->flags == b->flags &&
+         a->invisible_glyph == b->invisible_glyph &&
+         a->text_len == b->text_len &&
+         a->features_len == b->features_len &&
+         memcmp (a->text, b->text, sizeof (uint32_t) * a->text_len) == 0 &&
+         (!a->features_len ||
+          memcmp (a->features, b->features,
+                  sizeof (hb_feature_t) * a->features_len) == 0);
+}
+
+static void
+_raqm_cache_unlink (_raqm_cache       *cache,
+                    _raqm_cache_entry *entry)
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    cache->head = entry->next;
+
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    cache->tail = entry->prev;
+
+  entry->prev = entry->next = NULL;
+}
+
+static void
+_raqm_cache_push_front (_raqm_cache       *cache,
+                        _raqm_cache_entry *entry)
+{
+  entry->prev = NULL;
+  entry->next = cache->head;
+
+  if (cache->head)
+    cache->head->prev = entry;
+  else
+    cache->tail = entry;
+
+  cache->head = entry;
+}
+
+static void
+_raqm_cache_evict (_raqm_cache *cache)
+{
+  _raqm_cache_entry *entry = cache->tail;
+  _raqm_cache_entry **p;
+
+  if (!entry)
+    return;
+
+  p = &cache->buckets[entry->hash & (cache->buckets_len - 1)];
+  while (*p != entry)
+    p = &(*p)->bucket_next;
+  *p = entry->bucket_next;
+
+  _raqm_cache_unlink (cache, entry);
+  cache->len--;
+  cache->size -= entry->size;
+  cache->destroy (cache->allocator, entry);
+}
+
+/* Sets the maximum number of entries and their total size (0 for no size
+ * limit), evicting the least recently used ones if needed and rehashing the
+ * rest. */
+static bool
+_raqm_cache_resize (_raqm_cache *cache,
+                    size_t       max_len,
+                    size_t       max_size)
+{
+  _raqm_cache_entry **buckets = NULL;
+  size_t buckets_len = 0;
+
+  while (cache->len > max_len || (max_size && cache->size > max_size))
+    _raqm_cache_evict (cache);
+
+  if (max_len)
+  {
+    buckets_len = 16;
+    while (buckets_len < max_len)
+      buckets_len *= 2;
+
+    buckets = _raqm_calloc (cache->allocator, buckets_len,
+                            sizeof (_raqm_cache_entry *));
+    if (!buckets)
+      return false;
+
+    for (_raqm_cache_entry *e = cache->head; e; e = e->next)
+    {
+      size_t i = e->hash & (buckets_len - 1);
+      e->bucket_next = buckets[i];
+      buckets[i] = e;
+    }
+  }
+
+  _raqm_free (cache->allocator, cache->buckets);
+  cache->buckets = buckets;
+  cache->buckets_len = buckets_len;
+  cache->max_len = max_len;
+  cache->max_size = max_size;
+
+  return true;
+}
+
+/* Returns the entry with @hash for which @equal returns true, making it the
+ * most recently used one. Hits and misses are counted by the callers, which
+ * may have other places to look. */
+static _raqm_cache_entry *
+_raqm_cache_lookup (_raqm_cache *cache,
+                    uint32_t     hash,
+                    bool       (*equal) (const _raqm_cache_entry *entry,
+                                         const void              *key),
+                    const void  *key)
+{
+  _raqm_cache_entry *entry;
+
+  entry = cache->buckets[hash & (cache->buckets_len - 1)];
+  for (; entry; entry = entry->bucket_next)
+  {
+    if (entry->hash == hash && equal (entry, key))
+    {
+      _raqm_cache_unlink (cache, entry);
+      _raqm_cache_push_front (cache, entry);
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+/* Takes ownership of @entry, whose hash and size must be set. Entries larger
+ * than the whole cache are dropped right away. */
+static void
+_raqm_cache_insert (_raqm_cache       *cache,
+                    _raqm_cache_entry *entry)
+{
+  size_t i;
+
+  if (cache->max_size && entry->size > cache->max_size)
+  {
+    cache->destroy (cache->allocator, entry);
+    return;
+  }
+
+  while (cache->len >= cache->max_len ||
+         (cache->max_size && cache->size + entry->size > cache->max_size))
+    _raqm_cache_evict (cache);
+
+  i = entry->hash & (cache->buckets_len - 1);
+  entry->bucket_next = cache->buckets[i];
+  cache->buckets[i] = entry;
+  _raqm_cache_push_front (cache, entry);
+  cache->len++;
+  cache->size += entry->size;
+}
+
+static void
+_raqm_word_entry_destroy (const _raqm_allocator *allocator,
+                          _raqm_cache_entry     *base)
+{
+  _raqm_word_entry *entry = (_raqm_word_entry *) base;
+
+  hb_font_destroy (entry->key.font);
+  _raqm_free (allocator, entry);
+}
+
+static bool
+_raqm_word_entry_equal (const _raqm_cache_entry *base,
+                        const void              *key)
+{
+  return _raqm_word_key_equal (&((const _raqm_word_entry *) base)->key, key);
+}
+
+static _raqm_word_entry *
+_raqm_word_cache_lookup (_raqm_cache          *cache,
+                         const _raqm_word_key *key)
+{
+  return (_raqm_word_entry *) _raqm_cache_lookup (cache, key->hash,
+                                                  _raqm_word_entry_equal, key);
+}
+
+/* Stores a copy of the shaped glyphs in @buffer under @key. Glyph clusters
+ * are expected to be relative to the start of the word. */
+static void
+_raqm_word_cache_insert (_raqm_cache          *cache,
+                         const _raqm_word_key *key,
+                         hb_buffer_t          *buffer)
+{
+  _raqm_word_entry *entry;
+  hb_glyph_info_t *info;
+  hb_glyph_position_t *pos;
+  unsigned int len;
+  size_t size;
+
+  info = hb_buffer_get_glyph_infos (buffer, &len);
+  pos = hb_buffer_get_glyph_positions (buffer, NULL);
+
+  size = sizeof (_raqm_word_entry) +
+         (sizeof (hb_glyph_info_t) + sizeof (hb_glyph_position_t)) * len +
+         sizeof (hb_feature_t) * key->features_len +
+         sizeof (uint32_t) * key->text_len;
+
+  entry = _raqm_malloc (cache->allocator, size);
+  if (!entry)
+    return;
+
+  entry->base.hash = key->hash;
+  entry->base.size = size;
+  entry->key = *key;
+  entry->key.font = hb_font_reference (key->font);
+  entry->len = len;
+  entry->info = (hb_glyph_info_t *) (entry + 1);
+  entry->pos = (hb_glyph_position_t *) (entry->info + len);
+  entry->key.features = (hb_feature_t *) (entry->pos + len);
+  entry->key.text = (uint32_t *) (entry->key.features + key->features_len);
+
+  memcpy (entry->info, info, sizeof (hb_glyph_info_t) * len);
+  memcpy (entry->pos, pos, sizeof (hb_glyph_position_t) * len);
+  if (key->features_len)
+    memcpy ((hb_feature_t *) entry->key.features, key->features,
+            sizeof (hb_feature_t) * key->features_len);
+  memcpy ((uint32_t *) entry->key.text, key->text,
+          sizeof (uint32_t) * key->text_len);
+
+  _raqm_cache_insert (cache, &entry->base);
+}
+
+static void
+_raqm_layout_entry_destroy (const _raqm_allocator *allocator,
+                            _raqm_cache_entry     *base)
+{
+  _raqm_layout_entry *entry = (_raqm_layout_entry *) base;
+
+  for (size_t i = 0; i < entry->faces_len; i++)
+    FT_Done_Face (entry->faces[i]);
+
+  _raqm_free (allocator, entry);
+}
+
+static bool
+_raqm_layout_entry_equal (const _raqm_cache_entry *base,
+                          const void              *key)
+{
+  const _raqm_layout_key *a = &((const _raqm_layout_entry *) base)->key;
+  const _raqm_layout_key *b = key;
+
+  return a->len == b->len && memcmp (a->data, b->data, a->len) == 0;
+}
+
+/* Word cache files.
+ *
+ * The file is laid out so that it can be used in place once mapped, without
+ * parsing: a header, a hash table of offsets to the first entry of each
+ * bucket, and the entries, each followed by its text, features, glyphs and
+ * language. All offsets are from the start of the file, and all fields are
+ * 32-bit in native byte order, which the header records.
+ *
+ * Entries can’t refer to fonts by pointer, so they are keyed on a fingerprint
+ * of the font instead, see _raqm_compute_font_fingerprint(), and on the
+ * language name. Since the output depends on the shaper, the file is only
+ * used with the HarfBuzz version it was written with. */
+
+#define RAQM_WORD_FILE_MAGIC "RAQMWORD"
+#define RAQM_WORD_FILE_VERSION 1
+#define RAQM_WORD_FILE_BYTE_ORDER 0x01020304
+
+typedef struct
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t hb_version[3];
+  uint32_t size;
+  uint32_t entries_len;
+  uint32_t buckets_len;
+} _raqm_word_file_header;
+
+typedef struct
+{
+  uint32_t next;
+  uint32_t hash;
+  uint32_t fingerprint[2];
+  int32_t  x_scale;
+  int32_t  y_scale;
+  uint32_t script;
+  uint32_t direction;
+  uint32_t flags;
+  int32_t  invisible_glyph;
+  uint32_t lang_len;
+  uint32_t text_len;
+  uint32_t features_len;
+  uint32_t glyphs_len;
+} _raqm_word_file_entry;
+
+typedef struct
+{
+  uint32_t codepoint;
+  uint32_t mask;
+  uint32_t cluster;
+  int32_t  x_advance;
+  int32_t  y_advance;
+  int32_t  x_offset;
+  int32_t  y_offset;
+} _raqm_word_file_glyph;
+
+/* Returns a fingerprint of the font tables of @face, @loadflags and @funcs,
+ * or 0 if the face is not an sfnt font or is a variable one.
+ *
+ * Hashing all the font data would be too slow, so this hashes the tags and
+ * lengths of all the tables, and the whole 'head' table, which has the
+ * checksum of the font file, its revision and modification date. */
+static uint64_t
+_raqm_compute_font_fingerprint (FT_Face           face,
+                                int               loadflags,
+                                raqm_font_funcs_t funcs)
+{
+  uint64_t hash = 14695981039346656037u;
+  unsigned char head[54];
+  FT_ULong length = sizeof (head);
+  FT_ULong count = 0;
+
+  if (!FT_IS_SFNT (face) || FT_HAS_MULTIPLE_MASTERS (face))
+    return 0;
+
+  if (FT_Load_Sfnt_Table (face, TTAG_head, 0, head, &length))
+    return 0;
+
+  /* With no tag, the length is the number of tables */
+  FT_Sfnt_Table_Info (face, 0, NULL, &count);
+
+  for (FT_ULong i = 0; i <= count; i++)
+  {
+    FT_ULong tag = 0, table_length = 0;
+    uint32_t values[3];
+    const unsigned char *p = (const unsigned char *) values;
+
+    if (i < count)
+    {
+      if (FT_Sfnt_Table_Info (face, i, &tag, &table_length))
+        continue;
+
+      values[0] = tag;
+      values[1] = table_length;
+      values[2] = 0;
+    }
+    else
+    {
+      values[0] = face->face_index;
+      values[1] = loadflags;
+      values[2] = funcs;
+    }
+
+    for (size_t j = 0; j < sizeof (values); j++)
+    {
+      hash ^= p[j];
+      hash *= 1099511628211u;
+    }
+  }
+
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= head[i];
+    hash *= 1099511628211u;
+  }
+
+  return hash ? hash : 1;
+}
+
+/* Returns the hb-ft font of @font, which is its parent when the glyph cache
+ * is used, see _raqm_create_hb_font(), or NULL if @font does not use
+ * FreeType. */
+static hb_font_t *
+_raqm_get_ft_font (hb_font_t *font)
+{
+  if (hb_ft_font_get_ft_face (font))
+    return font;
+
+  font = hb_font_get_parent (font);
+  if (font && hb_ft_font_get_ft_face (font))
+    return font;
+
+  return NULL;
+}
+
+static uint64_t
+_raqm_get_font_fingerprint (raqm_t    *rq,
+                            hb_font_t *font)
+{
+  hb_font_t *ft_font;
+
+  for (size_t i = 0; i < rq->fonts_len; i++)
+  {
+    _raqm_font_cache_entry *entry = &rq->fonts[i];
+
+    if (entry->font == font)
+    {
+      if (!entry->has_fingerprint)
+      {
+        entry->fingerprint = _raqm_compute_font_fingerprint (
+            entry->ftface,
+            entry->funcs == RAQM_FONT_FUNCS_FREETYPE ? entry->ftloadflags : -1,
+            entry->funcs);
+        entry->has_fingerprint = true;
+      }
+
+      return entry->fingerprint;
+    }
+  }
+
+  /* Fonts dropped from the font cache can still be used by the word cache,
+   * only those using FreeType can be identified then. */
+  ft_font = _raqm_get_ft_font (font);
+  if (!ft_font)
+    return 0;
+
+  return _raqm_compute_font_fingerprint (hb_ft_font_get_ft_face (ft_font),
+                                         hb_ft_font_get_load_flags (ft_font),
+                                         RAQM_FONT_FUNCS_FREETYPE);
+}
+
+/* Fills @file_entry with the parts of @key that can be stored in a file,
+ * including its hash, and @lang with the language name. Returns false if the
+ * key can’t be stored. */
+static bool
+_raqm_word_file_key (raqm_t                *rq,
+                     const _raqm_word_key  *key,
+                     _raqm_word_file_entry *file_entry,
+                     const char           **lang)
+{
+  uint64_t fingerprint = _raqm_get_font_fingerprint (rq, key->font);
+  uint32_t hash = RAQM_HASH_INIT;
+
+  if (!fingerprint)
+    return false;
+
+  *lang = hb_language_to_string (key->lang);
+  if (!*lang)
+    *lang = "";
+
+  memset (file_entry, 0, sizeof (_raqm_word_file_entry));
+  file_entry->fingerprint[0] = (uint32_t) fingerprint;
+  file_entry->fingerprint[1] = (uint32_t) (fingerprint >> 32);
+  file_entry->x_scale = key->x_scale;
+  file_entry->y_scale = key->y_scale;
+  file_entry->script = key->script;
+  file_entry->direction = key->direction;
+  file_entry->flags = key->flags;
+  file_entry->invisible_glyph = key->invisible_glyph;
+  file_entry->lang_len = strlen (*lang);
+  file_entry->text_len = key->text_len;
+  file_entry->features_len = key->features_len;
+
+  /* Everything up to the lengths, and the variable length parts */
+  hash = _raqm_hash (hash, &file_entry->fingerprint,
+                     offsetof (_raqm_word_file_entry, glyphs_len) -
+                     offsetof (_raqm_word_file_entry, fingerprint));
+  hash = _raqm_hash (hash, key->text, sizeof (uint32_t) * key->text_len);
+  if (key->features_len)
+    hash = _raqm_hash (hash, key->features,
+                       sizeof (hb_feature_t) * key->features_len);
+  hash = _raqm_hash (hash, *lang, file_entry->lang_len);
+  file_entry->hash = hash;
+
+  return true;
+}
+
+static size_t
+_raqm_word_file_entry_size (const _raqm_word_file_entry *entry)
+{
+  return sizeof (_raqm_word_file_entry) +
+         sizeof (uint32_t) * entry->text_len +
+         sizeof (hb_feature_t) * entry->features_len +
+         sizeof (_raqm_word_file_glyph) * entry->glyphs_len +
+         ((entry->lang_len + 3) & ~3u);
+}
+
+static void
+_raqm_word_file_unload (raqm_t *rq)
+{
+  if (!rq->word_file)
+    return;
+
+#ifdef HAVE_MMAP
+  if (rq->word_file_mapped)
+    munmap ((void *) rq->word_file, rq->word_file_size);
+  else
+#endif
+    _raqm_free (&rq->allocator, (void *) rq->word_file);
+
+  rq->word_file = NULL;
+  rq->word_file_size = 0;
+  rq->word_file_mapped = false;
+}
+
+/* Looks up @key in the loaded word cache file, and if found fills @buffer
+ * with its glyphs. */
+static bool
+_raqm_word_file_lookup (raqm_t               *rq,
+                        const _raqm_word_key *key,
+                        hb_buffer_t          *buffer)
+{
+  const _raqm_word_file_header *header;
+  const uint32_t *buckets;
+  _raqm_word_file_entry wanted;
+  const char *lang;
+  uint32_t offset;
+
+  if (!rq->word_file || !_raqm_word_file_key (rq, key, &wanted, &lang))
+    return false;
+
+  header = (const _raqm_word_file_header *) rq->word_file;
+  buckets = (const uint32_t *) (header + 1);
+  offset = buckets[wanted.hash & (header->buckets_len - 1)];
+
+  /* Offsets are checked before use, and chains only go forward, so that a
+   * corrupt file can’t make us read out of bounds or loop. */
+  while (offset)
+  {
+    const _raqm_word_file_entry *entry;
+    const uint32_t *text;
+    const hb_feature_t *features;
+    const _raqm_word_file_glyph *glyphs;
+    const char *entry_lang;
+
+    if (offset % 4 ||
+        offset > rq->word_file_size ||
+        rq->word_file_size - offset < sizeof (_raqm_word_file_entry))
+      break;
+
+    entry = (const _raqm_word_file_entry *) (rq->word_file + offset);
+    if (entry->text_len > RAQM_WORD_CACHE_MAX_WORD_LEN ||
+        entry->features_len > rq->features_len ||
+        entry->glyphs_len > rq->word_file_size / sizeof (_raqm_word_file_glyph) ||
+        entry->lang_len > rq->word_file_size ||
+        _raqm_word_file_entry_size (entry) > rq->word_file_size - offset)
+      break;
+
+    text = (const uint32_t *) (entry + 1);
+    features = (const hb_feature_t *) (text + entry->text_len);
+    glyphs = (const _raqm_word_file_glyph *) (features + entry->features_len);
+    entry_lang = (const char *) (glyphs + entry->glyphs_len);
+
+    if (entry->hash == wanted.hash &&
+        memcmp (&entry->fingerprint, &wanted.fingerprint,
+                offsetof (_raqm_word_file_entry, glyphs_len) -
+                offsetof (_raqm_word_file_entry, fingerprint)) == 0 &&
+        memcmp (text, key->text, sizeof (uint32_t) * key->text_len) == 0 &&
+        (!key->features_len ||
+         memcmp (features, key->features,
+                 sizeof (hb_feature_t) * key->features_len) == 0) &&
+        memcmp (entry_lang, lang, entry->lang_len) == 0)
+    {
+      hb_glyph_info_t *info;
+      hb_glyph_position_t *pos;
+
+      if (!hb_buffer_set_length (buffer, entry->glyphs_len))
+        return false;
+
+      hb_buffer_set_content_type (buffer, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+      info = hb_buffer_get_glyph_infos (buffer, NULL);
+      pos = hb_buffer_get_glyph_positions (buffer, NULL);
+      for (uint32_t i = 0; i < entry->glyphs_len; i++)
+      {
+        memset (&info[i], 0, sizeof (hb_glyph_info_t));
+        memset (&pos[i], 0, sizeof (hb_glyph_position_t));
+        info[i].codepoint = glyphs[i].codepoint;
+        info[i].mask = glyphs[i].mask;
+        info[i].cluster = glyphs[i].cluster;
+        pos[i].x_advance = glyphs[i].x_advance;
+        pos[i].y_advance = glyphs[i].y_advance;
+        pos[i].x_offset = glyphs[i].x_offset;
+        pos[i].y_offset = glyphs[i].y_offset;
+      }
+
+      return true;
+    }
+
+    if (entry->next <= offset)
+      break;
+    offset = entry->next;
+  }
+
+  return false;
+}
+
+/* Loads the whole file in memory when it can’t be mapped */
+static bool
+_raqm_word_file_read (raqm_t     *rq,
+                      const char *filename)
+{
+  unsigned char *data = NULL;
+  FILE *file;
+  long size;
+
+  file = fopen (filename, "rb");
+  if (!file)
+    return false;
+
+  if (fseek (file, 0, SEEK_END) == 0 &&
+      (size = ftell (file)) > 0 &&
+      fseek (file, 0, SEEK_SET) == 0)
+  {
+    data = _raqm_malloc (&rq->allocator, size);
+    if (data && fread (data, 1, size, file) != (size_t) size)
+    {
+      _raqm_free (&rq->allocator, data);
+      data = NULL;
+    }
+  }
+
+  fclose (file);
+
+  if (!data)
+    return false;
+
+  rq->word_file = data;
+  rq->word_file_size = size;
+  rq->word_file_mapped = false;
+
+  return true;
+}
+
+#ifdef HAVE_MMAP
+static bool
+_raqm_word_file_map (raqm_t     *rq,
+                     const char *filename)
+{
+  struct stat st;
+  void *data;
+  int fd;
+
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  if (fstat (fd, &st) != 0 || st.st_size <= 0)
+  {
+    close (fd);
+    return false;
+  }
+
+  data = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+
+  if (data == MAP_FAILED)
+    return false;
+
+  rq->word_file = data;
+  rq->word_file_size = st.st_size;
+  rq->word_file_mapped = true;
+
+  return true;
+}
+#endif
+
+static bool
+_raqm_word_file_check (raqm_t *rq)
+{
+  const _raqm_word_file_header *header;
+  unsigned int major, minor, micro;
+
+  if (rq->word_file_size < sizeof (_raqm_word_file_header))
+    return false;
+
+  header = (const _raqm_word_file_header *) rq->word_file;
+  hb_version (&major, &minor, &micro);
+
+  return memcmp (header->magic, RAQM_WORD_FILE_MAGIC, 8) == 0 &&
+         header->version == RAQM_WORD_FILE_VERSION &&
+         header->byte_order == RAQM_WORD_FILE_BYTE_ORDER &&
+         header->hb_version[0] == major &&
+         header->hb_version[1] == minor &&
+         header->hb_version[2] == micro &&
+         header->size == rq->word_file_size &&
+         header->buckets_len &&
+         (header->buckets_len & (header->buckets_len - 1)) == 0 &&
+         header->buckets_len <= (rq->word_file_size -
+                                 sizeof (_raqm_word_file_header)) /
+                                sizeof (uint32_t);
+}
+
+static bool
+_raqm_word_file_write (raqm_t     *rq,
+                       const char *filename)
+{
+  _raqm_word_file_header *header;
+  _raqm_word_file_entry *file_entries;
+  _raqm_word_entry **entries;
+  const char **langs;
+  uint32_t *buckets, *tails = NULL;
+  unsigned char *data = NULL;
+  char *tmp_filename = NULL;
+  size_t entries_len = 0, buckets_len = 1, size, offset;
+  unsigned int major, minor, micro;
+  bool ok = false;
+  FILE *file;
+
+  /* One element more, so that an empty cache does not allocate 0 bytes,
+   * for which malloc() may return NULL. */
+  file_entries = _raqm_malloc (&rq->allocator,
+                               sizeof (_raqm_word_file_entry) *
+                               (rq->word_cache.len + 1));
+  entries = _raqm_malloc (&rq->allocator,
+                          sizeof (_raqm_word_entry *) *
+                          (rq->word_cache.len + 1));
+  langs = _raqm_malloc (&rq->allocator,
+                        sizeof (char *) * (rq->word_cache.len + 1));
+  if (!file_entries || !entries || !langs)
+    goto done;
+
+  size = sizeof (_raqm_word_file_header);
+  for (_raqm_cache_entry *e = rq->word_cache.head; e; e = e->next)
+  {
+    _raqm_word_entry *entry = (_raqm_word_entry *) e;
+    _raqm_word_file_entry *file_entry = &file_entries[entries_len];
+
+    if (!_raqm_word_file_key (rq, &entry->key, file_entry,
+                              &langs[entries_len]))
+      continue;
+
+    file_entry->glyphs_len = entry->len;
+    size += _raqm_word_file_entry_size (file_entry);
+    entries[entries_len++] = entry;
+  }
+
+  while (buckets_len < entries_len)
+    buckets_len *= 2;
+  size += sizeof (uint32_t) * buckets_len;
+
+  if (size > UINT32_MAX)
+    goto done;
+
+  data = _raqm_calloc (&rq->allocator, 1, size);
+  tails = _raqm_calloc (&rq->allocator, buckets_len, sizeof (uint32_t));
+  if (!data || !tails)
+    goto done;
+
+  header = (_raqm_word_file_header *) data;
+  memcpy (header->magic, RAQM_WORD_FILE_MAGIC, 8);
+  hb_version (&major, &minor, &micro);
+  header->version = RAQM_WORD_FILE_VERSION;
+  header->byte_order = RAQM_WORD_FILE_BYTE_ORDER;
+  header->hb_version[0] = major;
+  header->hb_version[1] = minor;
+  header->hb_version[2] = micro;
+  header->size = size;
+  header->entries_len = entries_len;
+  header->buckets_len = buckets_len;
+
+  buckets = (uint32_t *) (header + 1);
+  offset = sizeof (_raqm_word_file_header) + sizeof (uint32_t) * buckets_len;
+
+  for (size_t i = 0; i < entries_len; i++)
+  {
+    const _raqm_word_entry *entry = entries[i];
+    _raqm_word_file_entry *file_entry;
+    _raqm_word_file_glyph *glyphs;
+    uint32_t *text;
+    hb_feature_t *features;
+    size_t bucket = file_entries[i].hash & (buckets_len - 1);
+
+    file_entry = (_raqm_word_file_entry *) (data + offset);
+    *file_entry = file_entries[i];
+
+    text = (uint32_t *) (file_entry + 1);
+    features = (hb_feature_t *) (text + file_entry->text_len);
+    glyphs = (_raqm_word_file_glyph *) (features + file_entry->features_len);
+
+    memcpy (text, entry->key.text, sizeof (uint32_t) * file_entry->text_len);
+    if (file_entry->features_len)
+      memcpy (features, entry->key.features,
+              sizeof (hb_feature_t) * file_entry->features_len);
+    for (uint32_t j = 0; j < file_entry->glyphs_len; j++)
+    {
+      glyphs[j].codepoint = entry->info[j].codepoint;
+      glyphs[j].mask = entry->info[j].mask;
+      glyphs[j].cluster = entry->info[j].cluster;
+      glyphs[j].x_advance = entry->pos[j].x_advance;
+      glyphs[j].y_advance = entry->pos[j].y_advance;
+      glyphs[j].x_offset = entry->pos[j].x_offset;
+      glyphs[j].y_offset = entry->pos[j].y_offset;
+    }
+    memcpy (glyphs + file_entry->glyphs_len, langs[i], file_entry->lang_len);
+
+    /* Append to the bucket chain, so that chains only go forward */
+    if (tails[bucket])
+      ((_raqm_word_file_entry *) (data + tails[bucket]))->next = offset;
+    else
+      buckets[bucket] = offset;
+    tails[bucket] = offset;
+
+    offset += _raqm_word_file_entry_size (file_entry);
+  }
+
+  /* Write to a new file and move it in place, so that processes using the
+   * old file keep seeing it whole. */
+  tmp_filename = _raqm_malloc (&rq->allocator,
+                               strlen (filename) + sizeof (".tmp"));
+  if (!tmp_filename)
+    goto done;
+  strcpy (tmp_filename, filename);
+  strcat (tmp_filename, ".tmp");
+
+  file = fopen (tmp_filename, "wb");
+  if (!file)
+    goto done;
+
+  ok = fwrite (data, 1, size, file) == size;
+  ok = fclose (file) == 0 && ok;
+
+  /* rename() does not replace existing files on Windows */
+  if (ok && rename (tmp_filename, filename) != 0)
+    ok = remove (filename) == 0 && rename (tmp_filename, filename) == 0;
+
+  if (!ok)
+    remove (tmp_filename);
+
+done:
+  _raqm_free (&rq->allocator, tmp_filename);
+  _raqm_free (&rq->allocator, file_entries);
+  _raqm_free (&rq->allocator, entries);
+  _raqm_free (&rq->allocator, langs);
+  _raqm_free (&rq->allocator, tails);
+  _raqm_free (&rq->allocator, data);
+
+  return ok;
+}
+
+/**
+ * raqm_create:
+ *
+ * Creates a new #raqm_t with all its internal states initialized to their
+ * defaults.
+ *
+ * Return value:
+ * A newly allocated #raqm_t with a reference count of 1. The initial reference
+ * count should be released with raqm_destroy() when you are done using the
+ * #raqm_t. Returns `NULL` in case of error.
+ *
+ * Since: 0.1
+ */
+raqm_t *
+raqm_create (void)
+{
+  return raqm_create_with_allocator (_raqm_default_malloc,
+                                     _raqm_default_realloc,
+                                     _raqm_default_free,
+                                     NULL);
+}
+
+/**
+ * raqm_create_with_allocator:
+ * @malloc_func: the function to allocate memory with.
+ * @realloc_func: the function to resize memory allocated by @malloc_func.
+ * @free_func: the function to release memory allocated by @malloc_func or
+ * @realloc_func.
+ * @user_data: data to pass to the functions.
+ *
+ * Like raqm_create(), but all the memory of the new #raqm_t, including the
+ * object itself and the glyphs returned by raqm_get_glyphs(), is allocated
+ * with the given functions instead of the C library ones. The functions
+ * follow the semantics of malloc(), realloc() and free(), and @free_func is
+ * never called with `NULL`.
+ *
+ * Memory allocated internally by HarfBuzz, FreeType and FriBidi is not
+ * covered.
+ *
+ * Return value:
+ * A newly allocated #raqm_t with a reference count of 1, to be released with
+ * raqm_destroy(). Returns `NULL` if any of the functions is `NULL` or in case
+ * of error.
+ *
+ * Since: 0.12
+ */
+raqm_t *
+raqm_create_with_allocator (raqm_malloc_func_t  malloc_func,
+                            raqm_realloc_func_t realloc_func,
+                            raqm_free_func_t    free_func,
+                            void               *user_data)
+{
+  raqm_t *rq;
+
+  if (!malloc_func || !realloc_func || !free_func)
+    return NULL;
+
+  rq = malloc_func (sizeof (raqm_t), user_data);
+  if (!rq)
+    return NULL;
+
+  rq->ref_count = 1;
+
+  rq->allocator.malloc_func = malloc_func;
+  rq->allocator.realloc_func = realloc_func;
+  rq->allocator.free_func = free_func;
+  rq->allocator.user_data = user_data;
+
+  rq->base_dir = RAQM_DIRECTION_DEFAULT;
+  rq->resolved_dir = RAQM_DIRECTION_DEFAULT;
+
+  rq->features = NULL;
+  rq->features_len = 0;
+
+  rq->invisible_glyph = 0;
+  rq->font_funcs = RAQM_FONT_FUNCS_FREETYPE;
+
+  rq->text = NULL;
+  rq->text_memory = NULL;
+  rq->text_utf16 = NULL;
   rq->text_utf8 = NULL;
-  rq->text_info = NULL;
+  rq->spans = NULL;
+  rq->spans_len = 0;
+  rq->spans_capacity = 0;
+
+  rq->grapheme_breaks = NULL;
+  rq->grapheme_breaks_capacity = 0;
+  rq->grapheme_breaks_valid = false;
+  rq->scripts = NULL;
   rq->text_capacity_bytes = 0;
   rq->text_len = 0;
 
   rq->runs = NULL;
-  rq->runs_pool = NULL;
+  rq->runs_len = 0;
+  rq->runs_capacity = 0;
+  rq->runs_logical = NULL;
+
+  rq->arena = NULL;
 
   rq->glyphs = NULL;
+  rq->glyph_clusters = NULL;
+  rq->glyphs_len = 0;
   rq->glyphs_capacity = 0;
 
+  rq->fonts_len = 0;
+  rq->fonts_max_kept = RAQM_FONT_CACHE_SIZE;
+
+  memset (&rq->word_cache, 0, sizeof (_raqm_cache));
+  rq->word_cache.allocator = &rq->allocator;
+  rq->word_cache.destroy = _raqm_word_entry_destroy;
+  rq->shape_buffer = NULL;
+  rq->word_file = NULL;
+  rq->word_file_size = 0;
+  rq->word_file_mapped = false;
+
+  memset (&rq->layout_cache, 0, sizeof (_raqm_cache));
+  rq->layout_cache.allocator = &rq->allocator;
+  rq->layout_cache.destroy = _raqm_layout_entry_destroy;
+  rq->layout_key = NULL;
+  rq->layout_key_len = 0;
+  rq->layout_key_capacity = 0;
+
+  rq->plans_len = 0;
+
   return rq;
 }
 
@@ -443,6 +2198,12 @@ raqm_reference (raqm_t *rq)
  * and all associated resources are freed.
  * See raqm_reference().
  *
+ * The #FT_Face objects used by @rq may stay referenced by its caches until
+ * then, so their FreeType library must not be freed before @rq is destroyed,
+ * unless the caches are disabled with raqm_set_font_cache_size(),
+ * raqm_set_word_cache_size() and raqm_set_layout_cache_size() and
+ * raqm_clear_contents() is called first.
+ *
  * Since: 0.1
  */
 void
@@ -451,13 +2212,23 @@ raqm_destroy (raqm_t *rq)
   if (!rq || --rq->ref_count != 0)
     return;
 
-  _raqm_release_text_info (rq);
+  _raqm_release_spans (rq);
+  _raqm_free (&rq->allocator, rq->spans);
+  _raqm_free (&rq->allocator, rq->grapheme_breaks);
   _raqm_free_text (rq);
-  _raqm_free_runs (rq->runs);
-  _raqm_free_runs (rq->runs_pool);
-  free (rq->glyphs);
-  free (rq->features);
-  free (rq);
+  _raqm_free_runs (rq);
+  _raqm_arena_free (rq);
+  _raqm_cache_resize (&rq->word_cache, 0, 0);
+  hb_buffer_destroy (rq->shape_buffer);
+  _raqm_word_file_unload (rq);
+  _raqm_cache_resize (&rq->layout_cache, 0, 0);
+  _raqm_free (&rq->allocator, rq->layout_key);
+  _raqm_free_shape_plans (rq);
+  _raqm_free_fonts (rq);
+  _raqm_free (&rq->allocator, rq->glyphs);
+  _raqm_free (&rq->allocator, rq->glyph_clusters);
+  _raqm_free (&rq->allocator, rq->features);
+  _raqm_free (&rq->allocator, rq);
 }
 
 /**
@@ -467,6 +2238,11 @@ raqm_destroy (raqm_t *rq)
  * Clears internal state of previously used raqm_t object, making it ready
  * for reuse and keeping some of allocated memory to increase performance.
  *
+ * The HarfBuzz fonts created for the faces used in previous layouts are also
+ * kept, so that laying out more text with the same faces does not have to
+ * load the font tables again. They hold a reference to their #FT_Face until
+ * they are dropped, see raqm_set_font_cache_size().
+ *
  * Since: 0.9
  */
 void
@@ -475,34 +2251,56 @@ raqm_clear_contents (raqm_t *rq)
   if (!rq)
     return;
 
-  _raqm_release_text_info (rq);
+  _raqm_release_spans (rq);
 
-  /* Return allocated runs to the pool, keep hb buffers for reuse */
-  raqm_run_t *run = rq->runs;
-  while (run)
-  {
-    if (run->buffer)
-      hb_buffer_reset (run->buffer);
+  _raqm_reset_runs (rq);
+  _raqm_arena_reset (rq);
+  _raqm_trim_fonts (rq, rq->fonts_max_kept);
 
-    if (run->font)
-    {
-      hb_font_destroy (run->font);
-      run->font = NULL;
-    }
+  rq->grapheme_breaks_valid = false;
 
-    if (!run->next)
-    {
-      run->next = rq->runs_pool;
-      rq->runs_pool = rq->runs;
-      rq->runs = NULL;
-      break;
-    }
+  /* The text may be borrowed, don’t keep pointing to it */
+  rq->text = NULL;
+  rq->text_utf8 = NULL;
+  rq->text_utf16 = NULL;
+  rq->text_encoded_len = 0;
+  rq->text_len = 0;
+  rq->resolved_dir = RAQM_DIRECTION_DEFAULT;
+}
+
+static bool
+_raqm_set_text (raqm_t         *rq,
+                const uint32_t *text,
+                size_t          len,
+                bool            borrowed)
+{
+  uint32_t *copy;
+
+  if (!rq || !text)
+    return false;
 
-    run = run->next;
+  /* Call raqm_clear_contents to reuse this raqm_t */
+  if (rq->text_len)
+    return false;
+
+  /* Empty string, don’t fail but do nothing */
+  if (!len)
+    return true;
+
+  copy = _raqm_alloc_text (rq, len, false, false, borrowed, NULL);
+  if (!copy)
+    return false;
+
+  if (borrowed)
+    rq->text = text;
+  else
+  {
+    memcpy (copy, text, sizeof (uint32_t) * len);
+    rq->text = copy;
   }
 
-  rq->text_len = 0;
-  rq->resolved_dir = RAQM_DIRECTION_DEFAULT;
+  rq->text_len = len;
+  return _raqm_init_spans (rq);
 }
 
 /**
@@ -529,25 +2327,30 @@ raqm_set_text (raqm_t         *rq,
                const uint32_t *text,
                size_t          len)
 {
-  if (!rq || !text)
-    return false;
-
-  /* Call raqm_clear_contents to reuse this raqm_t */
-  if (rq->text_len)
-    return false;
-
-  /* Empty string, don’t fail but do nothing */
-  if (!len)
-    return true;
-
-  if (!_raqm_alloc_text(rq, len, false, false))
-      return false;
-
-  rq->text_len = len;
-  memcpy (rq->text, text, sizeof (uint32_t) * len);
-  _raqm_init_text_info (rq);
+  return _raqm_set_text (rq, text, len, false);
+}
 
-  return true;
+/**
+ * raqm_set_text_borrowed:
+ * @rq: a #raqm_t.
+ * @text: a UTF-32 encoded text string.
+ * @len: the length of @text.
+ *
+ * Same as raqm_set_text(), but @text is used in place instead of being
+ * copied. It must stay valid and unchanged until raqm_clear_contents() or
+ * raqm_destroy() is called on @rq.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_text_borrowed (raqm_t         *rq,
+                        const uint32_t *text,
+                        size_t          len)
+{
+  return _raqm_set_text (rq, text, len, true);
 }
 
 /* Ported from HarfBuzz’s hb_utf8_t::next(). */
@@ -612,18 +2415,116 @@ _raqm_get_utf8_codepoint (const char *str,
   return str;
 }
 
+/* Stores the offsets falling in a block of @len codepoints, starting at
+ * codepoint @count and offset @in_len, that take one code unit each. */
+static void
+_raqm_store_block_offsets (size_t *offsets,
+                           size_t  count,
+                           size_t  in_len,
+                           size_t  len)
+{
+  size_t i = (count + RAQM_TEXT_OFFSETS_STEP - 1) / RAQM_TEXT_OFFSETS_STEP;
+
+  for (; i * RAQM_TEXT_OFFSETS_STEP < count + len; i++)
+    offsets[i] = in_len + (i * RAQM_TEXT_OFFSETS_STEP - count);
+}
+
+/* Copies the ASCII characters at the start of @text to @unicode, a block
+ * at a time, and returns how many were copied. Stops before the first NUL
+ * or non-ASCII byte, or the last partial block. */
+static size_t
+_raqm_widen_ascii (const char *text, size_t len, uint32_t *unicode)
+{
+  size_t i = 0;
+
+#if defined(RAQM_SSE2)
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for (; i + 16 <= len; i += 16)
+  {
+    __m128i v = _mm_loadu_si128 ((const __m128i *) (text + i));
+    __m128i lo, hi;
+
+    if (_mm_movemask_epi8 (_mm_or_si128 (v, _mm_cmpeq_epi8 (v, zero))))
+      break;
+
+    lo = _mm_unpacklo_epi8 (v, zero);
+    hi = _mm_unpackhi_epi8 (v, zero);
+    _mm_storeu_si128 ((__m128i *) (unicode + i), _mm_unpacklo_epi16 (lo, zero));
+    _mm_storeu_si128 ((__m128i *) (unicode + i + 4), _mm_unpackhi_epi16 (lo, zero));
+    _mm_storeu_si128 ((__m128i *) (unicode + i + 8), _mm_unpacklo_epi16 (hi, zero));
+    _mm_storeu_si128 ((__m128i *) (unicode + i + 12), _mm_unpackhi_epi16 (hi, zero));
+  }
+#elif defined(RAQM_NEON)
+  for (; i + 16 <= len; i += 16)
+  {
+    uint8x16_t v = vld1q_u8 ((const uint8_t *) text + i);
+    uint16x8_t lo, hi;
+
+    if (vmaxvq_u8 (v) >= 0x80 || vminvq_u8 (v) == 0)
+      break;
+
+    lo = vmovl_u8 (vget_low_u8 (v));
+    hi = vmovl_u8 (vget_high_u8 (v));
+    vst1q_u32 (unicode + i, vmovl_u16 (vget_low_u16 (lo)));
+    vst1q_u32 (unicode + i + 4, vmovl_u16 (vget_high_u16 (lo)));
+    vst1q_u32 (unicode + i + 8, vmovl_u16 (vget_low_u16 (hi)));
+    vst1q_u32 (unicode + i + 12, vmovl_u16 (vget_high_u16 (hi)));
+  }
+#else
+  for (; i + 8 <= len; i += 8)
+  {
+    uint64_t w;
+
+    memcpy (&w, text + i, sizeof (w));
+
+    /* Any byte with the high bit set, or any zero byte */
+    if ((w | ((w - 0x0101010101010101u) & ~w)) & 0x8080808080808080u)
+      break;
+
+    for (size_t j = 0; j < 8; j++)
+      unicode[i + j] = (unsigned char) text[i + j];
+  }
+#endif
+
+  return i;
+}
+
+/* Also stores in @offsets the offset of every RAQM_TEXT_OFFSETS_STEP
+ * codepoints, and in @in_len the number of bytes converted. */
 static size_t
-_raqm_u8_to_u32 (const char *text, size_t len, uint32_t *unicode)
+_raqm_u8_to_u32 (const char *text, size_t len, uint32_t *unicode,
+                 size_t *offsets, size_t *in_len)
 {
-  size_t in_len = 0;
   uint32_t *out_utf32 = unicode;
   const char *in_utf8 = text;
   const char *end = text + len;
 
-  while ((in_len < len) && (*in_utf8 != '\0'))
+  *in_len = 0;
+  while ((*in_len < len) && (*in_utf8 != '\0'))
   {
-    const char *out_utf8 = _raqm_get_utf8_codepoint (in_utf8, end, out_utf32);
-    in_len += out_utf8 - in_utf8;
+    const char *out_utf8;
+
+    if (!(*in_utf8 & 0x80))
+    {
+      size_t count = out_utf32 - unicode;
+      size_t ascii = _raqm_widen_ascii (in_utf8, len - *in_len, out_utf32);
+
+      if (ascii)
+      {
+        _raqm_store_block_offsets (offsets, count, *in_len, ascii);
+        *in_len += ascii;
+        in_utf8 += ascii;
+        out_utf32 += ascii;
+        continue;
+      }
+    }
+
+    if ((out_utf32 - unicode) % RAQM_TEXT_OFFSETS_STEP == 0)
+      offsets[(out_utf32 - unicode) / RAQM_TEXT_OFFSETS_STEP] = *in_len;
+
+    out_utf8 = _raqm_get_utf8_codepoint (in_utf8, end, out_utf32);
+    *in_len += out_utf8 - in_utf8;
     in_utf8 = out_utf8;
     ++out_utf32;
   }
@@ -663,18 +2564,104 @@ _raqm_get_utf16_codepoint (const uint16_t *str,
   return str;
 }
 
+/* Copies the characters at the start of @text to @unicode, a block at a
+ * time, and returns how many were copied. Stops before the first NUL or
+ * surrogate, or the last partial block. */
+static size_t
+_raqm_widen_bmp (const uint16_t *text, size_t len, uint32_t *unicode)
+{
+  size_t i = 0;
+
+#if defined(RAQM_SSE2)
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i surrogate_mask = _mm_set1_epi16 ((short) 0xF800);
+  const __m128i surrogate = _mm_set1_epi16 ((short) 0xD800);
+
+  for (; i + 8 <= len; i += 8)
+  {
+    __m128i v = _mm_loadu_si128 ((const __m128i *) (text + i));
+    __m128i stop;
+
+    stop = _mm_or_si128 (_mm_cmpeq_epi16 (v, zero),
+                         _mm_cmpeq_epi16 (_mm_and_si128 (v, surrogate_mask),
+                                          surrogate));
+    if (_mm_movemask_epi8 (stop))
+      break;
+
+    _mm_storeu_si128 ((__m128i *) (unicode + i), _mm_unpacklo_epi16 (v, zero));
+    _mm_storeu_si128 ((__m128i *) (unicode + i + 4), _mm_unpackhi_epi16 (v, zero));
+  }
+#elif defined(RAQM_NEON)
+  for (; i + 8 <= len; i += 8)
+  {
+    uint16x8_t v = vld1q_u16 (text + i);
+    uint16x8_t stop;
+
+    stop = vorrq_u16 (vceqq_u16 (v, vdupq_n_u16 (0)),
+                      vceqq_u16 (vandq_u16 (v, vdupq_n_u16 (0xF800)),
+                                 vdupq_n_u16 (0xD800)));
+    if (vmaxvq_u16 (stop))
+      break;
+
+    vst1q_u32 (unicode + i, vmovl_u16 (vget_low_u16 (v)));
+    vst1q_u32 (unicode + i + 4, vmovl_u16 (vget_high_u16 (v)));
+  }
+#else
+  for (; i + 4 <= len; i += 4)
+  {
+    uint64_t w, s;
+
+    memcpy (&w, text + i, sizeof (w));
+    s = (w & 0xF800F800F800F800u) ^ 0xD800D800D800D800u;
+
+    /* Any zero unit, or any unit that is zero after the surrogate test */
+    if ((((w - 0x0001000100010001u) & ~w) |
+         ((s - 0x0001000100010001u) & ~s)) & 0x8000800080008000u)
+      break;
+
+    for (size_t j = 0; j < 4; j++)
+      unicode[i + j] = text[i + j];
+  }
+#endif
+
+  return i;
+}
+
+/* Also stores in @offsets the offset of every RAQM_TEXT_OFFSETS_STEP
+ * codepoints, and in @in_len the number of shorts converted. */
 static size_t
-_raqm_u16_to_u32 (const uint16_t *text, size_t len, uint32_t *unicode)
+_raqm_u16_to_u32 (const uint16_t *text, size_t len, uint32_t *unicode,
+                  size_t *offsets, size_t *in_len)
 {
-  size_t in_len = 0;
   uint32_t *out_utf32 = unicode;
   const uint16_t *in_utf16 = text;
   const uint16_t *end = text + len;
 
-  while ((in_len < len) && (*in_utf16 != '\0'))
+  *in_len = 0;
+  while ((*in_len < len) && (*in_utf16 != '\0'))
   {
-    const uint16_t *out_utf16 = _raqm_get_utf16_codepoint (in_utf16, end, out_utf32);
-    in_len += (out_utf16 - in_utf16);
+    const uint16_t *out_utf16;
+
+    if ((*in_utf16 & 0xF800) != 0xD800)
+    {
+      size_t count = out_utf32 - unicode;
+      size_t bmp = _raqm_widen_bmp (in_utf16, len - *in_len, out_utf32);
+
+      if (bmp)
+      {
+        _raqm_store_block_offsets (offsets, count, *in_len, bmp);
+        *in_len += bmp;
+        in_utf16 += bmp;
+        out_utf32 += bmp;
+        continue;
+      }
+    }
+
+    if ((out_utf32 - unicode) % RAQM_TEXT_OFFSETS_STEP == 0)
+      offsets[(out_utf32 - unicode) / RAQM_TEXT_OFFSETS_STEP] = *in_len;
+
+    out_utf16 = _raqm_get_utf16_codepoint (in_utf16, end, out_utf32);
+    *in_len += (out_utf16 - in_utf16);
     in_utf16 = out_utf16;
     ++out_utf32;
   }
@@ -682,6 +2669,80 @@ _raqm_u16_to_u32 (const uint16_t *text, size_t len, uint32_t *unicode)
   return (out_utf32 - unicode);
 }
 
+static bool
+_raqm_set_text_utf8 (raqm_t     *rq,
+                     const char *text,
+                     size_t      len,
+                     bool        borrowed)
+{
+  uint32_t *unicode;
+  void *copy;
+
+  if (!rq || !text)
+    return false;
+
+  /* Call raqm_clear_contents to reuse this raqm_t */
+  if (rq->text_len)
+    return false;
+
+  /* Empty string, don’t fail but do nothing */
+  if (!len)
+    return true;
+
+  unicode = _raqm_alloc_text (rq, len, true, false, borrowed, &copy);
+  if (!unicode)
+    return false;
+
+  rq->text_len = _raqm_u8_to_u32 (text, len, unicode, rq->text_offsets,
+                                  &rq->text_encoded_len);
+  rq->text = unicode;
+  if (borrowed)
+    rq->text_utf8 = text;
+  else
+  {
+    memcpy (copy, text, sizeof (char) * len);
+    rq->text_utf8 = copy;
+  }
+  return _raqm_init_spans (rq);
+}
+
+static bool
+_raqm_set_text_utf16 (raqm_t         *rq,
+                      const uint16_t *text,
+                      size_t          len,
+                      bool            borrowed)
+{
+  uint32_t *unicode;
+  void *copy;
+
+  if (!rq || !text)
+    return false;
+
+  /* Call raqm_clear_contents to reuse this raqm_t */
+  if (rq->text_len)
+    return false;
+
+  /* Empty string, don’t fail but do nothing */
+  if (!len)
+    return true;
+
+  unicode = _raqm_alloc_text (rq, len, false, true, borrowed, &copy);
+  if (!unicode)
+    return false;
+
+  rq->text_len = _raqm_u16_to_u32 (text, len, unicode, rq->text_offsets,
+                                   &rq->text_encoded_len);
+  rq->text = unicode;
+  if (borrowed)
+    rq->text_utf16 = text;
+  else
+  {
+    memcpy (copy, text, sizeof (uint16_t) * len);
+    rq->text_utf16 = copy;
+  }
+  return _raqm_init_spans (rq);
+}
+
 /**
  * raqm_set_text_utf8:
  * @rq: a #raqm_t.
@@ -700,25 +2761,30 @@ raqm_set_text_utf8 (raqm_t     *rq,
                     const char *text,
                     size_t      len)
 {
-  if (!rq || !text)
-    return false;
-
-  /* Call raqm_clear_contents to reuse this raqm_t */
-  if (rq->text_len)
-    return false;
-
-  /* Empty string, don’t fail but do nothing */
-  if (!len)
-    return true;
-
-  if (!_raqm_alloc_text(rq, len, true, false))
-      return false;
-
-  rq->text_len = _raqm_u8_to_u32 (text, len, rq->text);
-  memcpy (rq->text_utf8, text, sizeof (char) * len);
-  _raqm_init_text_info (rq);
+  return _raqm_set_text_utf8 (rq, text, len, false);
+}
 
-  return true;
+/**
+ * raqm_set_text_utf8_borrowed:
+ * @rq: a #raqm_t.
+ * @text: a UTF-8 encoded text string.
+ * @len: the length of @text in UTF-8 bytes.
+ *
+ * Same as raqm_set_text_utf8(), but @text is used in place instead of being
+ * copied, only its UTF-32 version is kept by @rq. It must stay valid and
+ * unchanged until raqm_clear_contents() or raqm_destroy() is called on @rq.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_text_utf8_borrowed (raqm_t     *rq,
+                             const char *text,
+                             size_t      len)
+{
+  return _raqm_set_text_utf8 (rq, text, len, true);
 }
 
 /**
@@ -739,26 +2805,32 @@ raqm_set_text_utf16 (raqm_t     *rq,
                     const uint16_t *text,
                     size_t      len)
 {
-  if (!rq || !text)
-    return false;
-
-  /* Call raqm_clear_contents to reuse this raqm_t */
-  if (rq->text_len)
-    return false;
-
-  /* Empty string, don’t fail but do nothing */
-  if (!len)
-    return true;
-
-  if (!_raqm_alloc_text(rq, len, false, true))
-      return false;
-
-  rq->text_len = _raqm_u16_to_u32 (text, len, rq->text);
-  memcpy (rq->text_utf16, text, sizeof (uint16_t) * len);
-  _raqm_init_text_info (rq);
+  return _raqm_set_text_utf16 (rq, text, len, false);
+}
 
-  return true;
+/**
+ * raqm_set_text_utf16_borrowed:
+ * @rq: a #raqm_t.
+ * @text: a UTF-16 encoded text string.
+ * @len: the length of @text in UTF-16 shorts.
+ *
+ * Same as raqm_set_text_utf16(), but @text is used in place instead of being
+ * copied, only its UTF-32 version is kept by @rq. It must stay valid and
+ * unchanged until raqm_clear_contents() or raqm_destroy() is called on @rq.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_text_utf16_borrowed (raqm_t         *rq,
+                              const uint16_t *text,
+                              size_t          len)
+{
+  return _raqm_set_text_utf16 (rq, text, len, true);
 }
+
 /**
  * raqm_set_par_direction:
  * @rq: a #raqm_t.
@@ -831,7 +2903,7 @@ raqm_set_language (raqm_t       *rq,
                    size_t        start,
                    size_t        len)
 {
-  hb_language_t language;
+  _raqm_text_span attrs;
   size_t end;
 
   if (!rq)
@@ -846,16 +2918,12 @@ raqm_set_language (raqm_t       *rq,
   if (start >= rq->text_len || end > rq->text_len)
     return false;
 
-  if (!rq->text_info)
+  if (!rq->spans_len)
     return false;
 
-  language = hb_language_from_string (lang, -1);
-  for (size_t i = start; i < end; i++)
-  {
-    rq->text_info[i].lang = language;
-  }
+  attrs.lang = hb_language_from_string (lang, -1);
 
-  return true;
+  return _raqm_set_spans (rq, start, end, &attrs, RAQM_SPAN_LANG);
 }
 
 static bool
@@ -867,7 +2935,7 @@ _raqm_add_font_feature (raqm_t       *rq,
   if (!rq)
     return false;
 
-  new_features = realloc (rq->features,
+  new_features = _raqm_realloc (&rq->allocator, rq->features,
                           sizeof (hb_feature_t) * (rq->features_len + 1));
   if (!new_features)
     return false;
@@ -911,30 +2979,274 @@ raqm_add_font_feature (raqm_t     *rq,
                        const char *feature,
                        int         len)
 {
-  hb_bool_t ok;
-  hb_feature_t fea;
+  hb_bool_t ok;
+  hb_feature_t fea;
+
+  if (!rq)
+    return false;
+
+  ok = hb_feature_from_string (feature, len, &fea);
+  if (ok)
+    _raqm_add_font_feature (rq, fea);
+
+  return ok;
+}
+
+static void
+_raqm_glyph_cache_destroy (void *data)
+{
+  _raqm_glyph_cache *cache = data;
+
+  _raqm_free (&cache->allocator, cache);
+}
+
+static void
+_raqm_glyph_cache_clear (_raqm_glyph_cache *cache)
+{
+  for (size_t i = 0; i < RAQM_GLYPH_CACHE_SIZE; i++)
+  {
+    cache->nominal_glyphs[i].key = RAQM_GLYPH_CACHE_EMPTY;
+    cache->h_advances[i].key = RAQM_GLYPH_CACHE_EMPTY;
+  }
+}
+
+static hb_bool_t
+_raqm_cached_nominal_glyph (hb_font_t      *font,
+                            void           *font_data,
+                            hb_codepoint_t  unicode,
+                            hb_codepoint_t *glyph,
+                            void           *user_data)
+{
+  _raqm_glyph_cache *cache = font_data;
+  _raqm_glyph_cache_slot *slot;
+
+  slot = &cache->nominal_glyphs[unicode & (RAQM_GLYPH_CACHE_SIZE - 1)];
+  if (slot->key != unicode)
+  {
+    hb_codepoint_t g;
+
+    if (!hb_font_get_nominal_glyph (hb_font_get_parent (font), unicode, &g))
+      g = RAQM_GLYPH_CACHE_EMPTY;
+
+    slot->key = unicode;
+    slot->value = g;
+  }
+
+  if (slot->value == RAQM_GLYPH_CACHE_EMPTY)
+    return false;
+
+  *glyph = slot->value;
+  return true;
+}
+
+static hb_position_t
+_raqm_cached_glyph_h_advance (hb_font_t      *font,
+                              void           *font_data,
+                              hb_codepoint_t  glyph,
+                              void           *user_data)
+{
+  _raqm_glyph_cache *cache = font_data;
+  _raqm_glyph_cache_slot *slot;
+
+  slot = &cache->h_advances[glyph & (RAQM_GLYPH_CACHE_SIZE - 1)];
+  if (slot->key != glyph)
+  {
+    slot->key = glyph;
+    slot->value = hb_font_get_glyph_h_advance (hb_font_get_parent (font),
+                                               glyph);
+  }
+
+  return (hb_position_t) slot->value;
+}
+
+/* Sets the scale of a font using the OpenType font functions the way hb-ft
+ * does for its fonts, so that both give the same units. */
+static void
+_raqm_set_ot_font_scale (hb_font_t *font,
+                         FT_Face    face)
+{
+  FT_Size_Metrics *metrics;
+
+  if (!face->size)
+    return;
+
+  metrics = &face->size->metrics;
+  hb_font_set_scale (font,
+                     (int) (((uint64_t) metrics->x_scale * face->units_per_EM +
+                             (1u << 15)) >> 16),
+                     (int) (((uint64_t) metrics->y_scale * face->units_per_EM +
+                             (1u << 15)) >> 16));
+  hb_font_set_ppem (font, metrics->x_ppem, metrics->y_ppem);
+}
+
+static bool
+_raqm_can_use_ot_funcs (FT_Face face)
+{
+  return FT_IS_SFNT (face) && FT_IS_SCALABLE (face) &&
+         !FT_HAS_MULTIPLE_MASTERS (face);
+}
+
+/* Creates the HarfBuzz font for @face and @loadflags.
+ *
+ * With #RAQM_FONT_FUNCS_OPENTYPE, faces that allow it get a font using the
+ * HarfBuzz OpenType functions, which read glyphs and advances from the font
+ * tables and need no cache.
+ *
+ * Otherwise, getting glyphs and advances from FreeType is slow, especially
+ * with hinting, so unless the face is a variable font the hb-ft font is
+ * wrapped in a sub font that caches them in @glyphs. The caches must be
+ * cleared when the face size changes, see _raqm_hb_font_changed(). */
+static hb_font_t *
+_raqm_create_hb_font (raqm_t             *rq,
+                      FT_Face             face,
+                      int                 loadflags,
+                      _raqm_glyph_cache **glyphs)
+{
+  hb_font_t *ft_font;
+  hb_font_funcs_t *funcs;
+  hb_font_t *font;
+
+  *glyphs = NULL;
+
+  if (rq->font_funcs == RAQM_FONT_FUNCS_OPENTYPE &&
+      _raqm_can_use_ot_funcs (face))
+  {
+    /* The tables are still loaded through FreeType, so that faces opened
+     * from memory or from custom streams work too. */
+    hb_face_t *hb_face = hb_ft_face_create_referenced (face);
+
+    font = hb_font_create (hb_face);
+    hb_face_destroy (hb_face);
+
+    hb_ot_font_set_funcs (font);
+    _raqm_set_ot_font_scale (font, face);
+
+    return font;
+  }
+
+  ft_font = hb_ft_font_create_referenced (face);
+
+  if (loadflags >= 0)
+    hb_ft_font_set_load_flags (ft_font, loadflags);
+
+  if (FT_HAS_MULTIPLE_MASTERS (face))
+    return ft_font;
+
+  *glyphs = _raqm_malloc (&rq->allocator, sizeof (_raqm_glyph_cache));
+  if (!*glyphs)
+    return ft_font;
+
+  _raqm_glyph_cache_clear (*glyphs);
+  (*glyphs)->allocator = rq->allocator;
+
+  funcs = hb_font_funcs_create ();
+  hb_font_funcs_set_nominal_glyph_func (funcs, _raqm_cached_nominal_glyph,
+                                        NULL, NULL);
+  hb_font_funcs_set_glyph_h_advance_func (funcs, _raqm_cached_glyph_h_advance,
+                                          NULL, NULL);
+  hb_font_funcs_make_immutable (funcs);
+
+  font = hb_font_create_sub_font (ft_font);
+  hb_font_set_funcs (font, funcs, *glyphs, _raqm_glyph_cache_destroy);
+
+  hb_font_funcs_destroy (funcs);
+  hb_font_destroy (ft_font);
+
+  return font;
+}
+
+/* Makes the font of @entry pick up a new face size */
+static void
+_raqm_hb_font_changed (_raqm_font_cache_entry *entry)
+{
+  hb_font_t *ft_font = _raqm_get_ft_font (entry->font);
 
-  if (!rq)
-    return false;
+  if (!ft_font)
+  {
+    _raqm_set_ot_font_scale (entry->font, entry->ftface);
+    return;
+  }
 
-  ok = hb_feature_from_string (feature, len, &fea);
-  if (ok)
-    _raqm_add_font_feature (rq, fea);
+  hb_ft_font_changed (ft_font);
 
-  return ok;
+  if (entry->glyphs)
+  {
+    int x_scale, y_scale;
+    unsigned int x_ppem, y_ppem;
+
+    hb_font_get_scale (ft_font, &x_scale, &y_scale);
+    hb_font_get_ppem (ft_font, &x_ppem, &y_ppem);
+    hb_font_set_scale (entry->font, x_scale, y_scale);
+    hb_font_set_ppem (entry->font, x_ppem, y_ppem);
+
+    _raqm_glyph_cache_clear (entry->glyphs);
+  }
 }
 
+/* Returns a new reference to the HarfBuzz font for @face and @loadflags.
+ *
+ * Fonts are cached on the raqm_t and reused across runs and across layouts
+ * (raqm_clear_contents() keeps up to rq->fonts_max_kept of them), so that
+ * HarfBuzz does not have to load the OpenType tables of the face over and
+ * over again. The cache is kept in most recently used order, and when it is
+ * full the least recently used font is dropped. */
 static hb_font_t *
-_raqm_create_hb_font (raqm_t *rq,
-                      FT_Face face,
-                      int     loadflags)
+_raqm_get_hb_font (raqm_t *rq,
+                   FT_Face face,
+                   int     loadflags)
 {
-  hb_font_t *font = hb_ft_font_create_referenced (face);
+  _raqm_font_cache_entry entry;
+  size_t i;
 
-  if (loadflags >= 0)
-    hb_ft_font_set_load_flags (font, loadflags);
+  for (i = 0; i < rq->fonts_len; i++)
+  {
+    if (rq->fonts[i].ftface == face &&
+        rq->fonts[i].ftloadflags == loadflags &&
+        rq->fonts[i].funcs == rq->font_funcs)
+      break;
+  }
 
-  return font;
+  if (i < rq->fonts_len)
+  {
+    entry = rq->fonts[i];
+
+    /* The client might have changed the face size since the font was
+     * created, the font needs to pick up the new scale then. Variable fonts
+     * are always refreshed as we can’t cheaply tell if their coordinates
+     * changed. */
+    if (entry.ftsize != face->size ||
+        (face->size && (entry.x_scale != face->size->metrics.x_scale ||
+                        entry.y_scale != face->size->metrics.y_scale)) ||
+        FT_HAS_MULTIPLE_MASTERS (face))
+    {
+      _raqm_hb_font_changed (&entry);
+    }
+  }
+  else
+  {
+    entry.font = _raqm_create_hb_font (rq, face, loadflags, &entry.glyphs);
+    if (!entry.font)
+      return NULL;
+
+    entry.ftface = face;
+    entry.ftloadflags = loadflags;
+    entry.funcs = rq->font_funcs;
+    entry.has_fingerprint = false;
+
+    _raqm_trim_fonts (rq, RAQM_FONT_CACHE_SIZE - 1);
+
+    i = rq->fonts_len++;
+  }
+
+  entry.ftsize = face->size;
+  entry.x_scale = face->size ? face->size->metrics.x_scale : 0;
+  entry.y_scale = face->size ? face->size->metrics.y_scale : 0;
+
+  /* Move to front */
+  memmove (rq->fonts + 1, rq->fonts, sizeof (_raqm_font_cache_entry) * i);
+  rq->fonts[0] = entry;
+
+  return hb_font_reference (entry.font);
 }
 
 static bool
@@ -943,6 +3255,8 @@ _raqm_set_freetype_face (raqm_t *rq,
                          size_t  start,
                          size_t  end)
 {
+  _raqm_text_span attrs;
+
   if (!rq)
     return false;
 
@@ -952,18 +3266,12 @@ _raqm_set_freetype_face (raqm_t *rq,
   if (start >= rq->text_len || end > rq->text_len)
     return false;
 
-  if (!rq->text_info)
+  if (!rq->spans_len)
     return false;
 
-  for (size_t i = start; i < end; i++)
-  {
-    if (rq->text_info[i].ftface)
-        FT_Done_Face (rq->text_info[i].ftface);
-    rq->text_info[i].ftface = face;
-    FT_Reference_Face (face);
-  }
+  attrs.ftface = face;
 
-  return true;
+  return _raqm_set_spans (rq, start, end, &attrs, RAQM_SPAN_FTFACE);
 }
 
 /**
@@ -1040,6 +3348,8 @@ _raqm_set_freetype_load_flags (raqm_t *rq,
                                size_t  start,
                                size_t  end)
 {
+  _raqm_text_span attrs;
+
   if (!rq)
     return false;
 
@@ -1049,13 +3359,12 @@ _raqm_set_freetype_load_flags (raqm_t *rq,
   if (start >= rq->text_len || end > rq->text_len)
     return false;
 
-  if (!rq->text_info)
+  if (!rq->spans_len)
     return false;
 
-  for (size_t i = start; i < end; i++)
-    rq->text_info[i].ftloadflags = flags;
+  attrs.ftloadflags = flags;
 
-  return true;
+  return _raqm_set_spans (rq, start, end, &attrs, RAQM_SPAN_FTLOADFLAGS);
 }
 
 /**
@@ -1129,6 +3438,9 @@ _raqm_set_spacing (raqm_t *rq,
                    size_t start,
                    size_t end)
 {
+  _raqm_text_span attrs;
+  size_t range_start = 0, range_end = 0;
+
   if (!rq)
     return false;
 
@@ -1138,166 +3450,446 @@ _raqm_set_spacing (raqm_t *rq,
   if (start >= rq->text_len || end > rq->text_len)
     return false;
 
-  if (!rq->text_info)
+  if (!rq->spans_len)
     return false;
 
+  attrs.spacing_after = spacing;
+
+  /* Set the spacing on each range of consecutive characters that get it */
   for (size_t i = start; i < end; i++)
   {
     bool set_spacing = i == 0;
     if (!set_spacing)
       set_spacing = raqm_allowed_grapheme_boundary (rq, i - 1);
 
-    if (set_spacing)
+    /* CSS word separators, word spacing is only applied on these.*/
+    if (set_spacing && word_spacing)
+      set_spacing = raqm_allowed_grapheme_boundary (rq, i) &&
+                    (rq->text[i] == 0x0020  || /* Space */
+                     rq->text[i] == 0x00A0  || /* No Break Space */
+                     rq->text[i] == 0x1361  || /* Ethiopic Word Space */
+                     rq->text[i] == 0x10100 || /* Aegean Word Separator Line */
+                     rq->text[i] == 0x10101 || /* Aegean Word Separator Dot */
+                     rq->text[i] == 0x1039F || /* Ugaric Word Divider */
+                     rq->text[i] == 0x1091F);  /* Phoenician Word Separator */
+
+    if (!set_spacing)
+      continue;
+
+    if (i != range_end)
     {
-      if (word_spacing)
-      {
-        if (raqm_allowed_grapheme_boundary (rq, i))
-        {
-          /* CSS word separators, word spacing is only applied on these.*/
-          if (rq->text[i] == 0x0020  || /* Space */
-              rq->text[i] == 0x00A0  || /* No Break Space */
-              rq->text[i] == 0x1361  || /* Ethiopic Word Space */
-              rq->text[i] == 0x10100 || /* Aegean Word Separator Line */
-              rq->text[i] == 0x10101 || /* Aegean Word Separator Dot */
-              rq->text[i] == 0x1039F || /* Ugaric Word Divider */
-              rq->text[i] == 0x1091F)   /* Phoenician Word Separator */
-          {
-            rq->text_info[i].spacing_after = spacing;
-          }
-        }
-      }
-      else
-      {
-        rq->text_info[i].spacing_after = spacing;
-      }
+      if (!_raqm_set_spans (rq, range_start, range_end, &attrs,
+                            RAQM_SPAN_SPACING_AFTER))
+        return false;
+      range_start = i;
+    }
+    range_end = i + 1;
+  }
+
+  return _raqm_set_spans (rq, range_start, range_end, &attrs,
+                          RAQM_SPAN_SPACING_AFTER);
+}
+
+/**
+ * raqm_set_letter_spacing_range:
+ * @rq: a #raqm_t.
+ * @spacing: amount of spacing in Freetype Font Units (26.6 format).
+ * @start: index of the first character that should use @spacing.
+ * @len: number of characters using @spacing.
+ *
+ * Set the letter spacing or tracking for a given range, the value
+ * will be added onto the advance and offset for RTL, and the advance for
+ * other directions. Letter spacing will be applied between characters, so
+ * the last character will not have spacing applied after it.
+ * Note that not all scripts have a letter-spacing tradition,
+ * for example, Arabic does not, while Devanagari does.
+ *
+ * This will also add “disable `liga`, `clig`, `hlig`, `dlig`, and `calt`” font
+ * features to the internal features list, so call this function after setting
+ * the font features for best spacing results.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.10
+ */
+bool
+raqm_set_letter_spacing_range(raqm_t *rq,
+                              int    spacing,
+                              size_t start,
+                              size_t len)
+{
+  size_t end;
+
+  if (!rq)
+    return false;
+
+  if (!rq->text_len)
+    return true;
+
+  end = start + len - 1;
+
+  if (spacing != 0)
+  {
+#define NUM_TAGS 5
+    static char *tags[NUM_TAGS] = { "clig", "liga", "hlig", "dlig", "calt" };
+    for (size_t i = 0; i < NUM_TAGS; i++)
+    {
+      hb_feature_t fea = { hb_tag_from_string(tags[i], 5), 0, start, end };
+      _raqm_add_font_feature (rq, fea);
     }
+#undef NUM_TAGS
   }
 
+  start = _raqm_encoding_to_u32_index (rq, start);
+  end = _raqm_encoding_to_u32_index (rq, end);
+
+  return _raqm_set_spacing (rq, spacing, false, start, end);
+}
+
+/**
+ * raqm_set_word_spacing_range:
+ * @rq: a #raqm_t.
+ * @spacing: amount of spacing in Freetype Font Units (26.6 format).
+ * @start: index of the first character that should use @spacing.
+ * @len: number of characters using @spacing.
+ *
+ * Set the word spacing for a given range. Word spacing will only be applied to
+ * 'word separator' characters, such as 'space', 'no break space' and
+ * 'Ethiopic word separator'.
+ * The value will be added onto the advance and offset for RTL, and the advance
+ * for other directions.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.10
+ */
+bool
+raqm_set_word_spacing_range(raqm_t *rq,
+                            int    spacing,
+                            size_t start,
+                            size_t len)
+{
+  size_t end;
+
+  if (!rq)
+    return false;
+
+  if (!rq->text_len)
+    return true;
+
+  end = _raqm_encoding_to_u32_index (rq, start + len);
+  start = _raqm_encoding_to_u32_index (rq, start);
+
+  return _raqm_set_spacing (rq, spacing, true, start, end);
+}
+
+/**
+ * raqm_set_invisible_glyph:
+ * @rq: a #raqm_t.
+ * @gid: glyph id to use for invisible glyphs.
+ *
+ * Sets the glyph id to be used for invisible glyphs.
+ *
+ * If @gid is negative, invisible glyphs will be suppressed from the output.
+ *
+ * If @gid is zero, invisible glyphs will be rendered as space.
+ *
+ * If @gid is a positive number, it will be used for invisible glyphs.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.6
+ */
+bool
+raqm_set_invisible_glyph (raqm_t *rq,
+                          int gid)
+{
+  if (!rq)
+    return false;
+
+  rq->invisible_glyph = gid;
   return true;
 }
 
 /**
- * raqm_set_letter_spacing_range:
+ * raqm_set_font_funcs:
+ * @rq: a #raqm_t.
+ * @funcs: the font functions to use.
+ *
+ * Sets where HarfBuzz gets glyph metrics (e.g. advances and extents) from
+ * during shaping.
+ *
+ * By default, they are loaded with FreeType using the load flags set with
+ * raqm_set_freetype_load_flags(), so they match the glyphs rendered with
+ * FreeType, including hinting. With #RAQM_FONT_FUNCS_OPENTYPE they are read
+ * directly from the OpenType tables of the font by HarfBuzz, which is much
+ * faster, but the load flags are ignored and the metrics are never hinted.
+ * This is best for unhinted layouts, e.g. with #FT_LOAD_NO_HINTING.
+ *
+ * Variable fonts, and fonts that are not scalable OpenType or TrueType
+ * fonts, always use FreeType.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_font_funcs (raqm_t           *rq,
+                     raqm_font_funcs_t funcs)
+{
+  if (!rq)
+    return false;
+
+  if (funcs != RAQM_FONT_FUNCS_FREETYPE && funcs != RAQM_FONT_FUNCS_OPENTYPE)
+    return false;
+
+  rq->font_funcs = funcs;
+  return true;
+}
+
+/**
+ * raqm_set_font_cache_size:
+ * @rq: a #raqm_t.
+ * @size: maximum number of fonts to keep between layouts, or 0 to keep none.
+ *
+ * Sets how many of the HarfBuzz fonts created for the faces used by @rq are
+ * kept by raqm_clear_contents(), so that later layouts with the same faces
+ * do not have to load their font tables again. Kept fonts hold a reference to
+ * their #FT_Face, keeping it alive until they are dropped.
+ *
+ * The least recently used fonts beyond @size are dropped right away. With 0,
+ * raqm_clear_contents() releases all the faces of @rq, as long as the word
+ * and layout caches are disabled too. The default and largest size is 16.
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_font_cache_size (raqm_t *rq,
+                          size_t  size)
+{
+  if (!rq || size > RAQM_FONT_CACHE_SIZE)
+    return false;
+
+  rq->fonts_max_kept = size;
+
+  /* Runs of the current layout hold their own font references */
+  _raqm_trim_fonts (rq, size);
+
+  return true;
+}
+
+/**
+ * raqm_set_word_cache_size:
+ * @rq: a #raqm_t.
+ * @size: maximum number of words to cache, or 0 to disable the cache.
+ *
+ * Enables caching the shaping output of individual words. When enabled, text
+ * runs are split at spaces (U+0020) into words, and each word is shaped on
+ * its own, so that the glyphs of words that appear again, in the same layout
+ * or in a later one with the same @rq, are reused instead of being shaped
+ * again. This can speed up the layout of repetitive text considerably.
+ *
+ * Since words are shaped separately, any font features that would apply
+ * across spaces (e.g. kerning with the space glyph, or contextual
+ * substitutions spanning several words) are not applied, so the output can
+ * differ from the output without the cache for some fonts.
+ *
+ * At most @size words are kept, and when the cache is full the least recently
+ * used words are dropped. Making the cache smaller drops the least recently
+ * used words to fit. The cache is disabled by default.
+ *
+ * See also raqm_get_word_cache_stats().
+ *
+ * Return value:
+ * `true` if no errors happened, `false` otherwise.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_set_word_cache_size (raqm_t *rq,
+                          size_t  size)
+{
+  if (!rq)
+    return false;
+
+  return _raqm_cache_resize (&rq->word_cache, size, 0);
+}
+
+/**
+ * raqm_get_word_cache_stats:
+ * @rq: a #raqm_t.
+ * @hits: (out) (optional): number of words found in the cache.
+ * @misses: (out) (optional): number of words not found in the cache.
+ *
+ * Gets the number of word cache hits and misses since @rq was created, see
+ * raqm_set_word_cache_size(). Words that can’t be cached, e.g. very long ones
+ * or ones that some font feature applies to only part of them, are not
+ * counted.
+ *
+ * Since: 0.12
+ */
+void
+raqm_get_word_cache_stats (raqm_t *rq,
+                           size_t *hits,
+                           size_t *misses)
+{
+  if (hits)
+    *hits = rq ? rq->word_cache.hits : 0;
+  if (misses)
+    *misses = rq ? rq->word_cache.misses : 0;
+}
+
+/**
+ * raqm_set_layout_cache_size:
  * @rq: a #raqm_t.
- * @spacing: amount of spacing in Freetype Font Units (26.6 format).
- * @start: index of the first character that should use @spacing.
- * @len: number of characters using @spacing.
- *
- * Set the letter spacing or tracking for a given range, the value
- * will be added onto the advance and offset for RTL, and the advance for
- * other directions. Letter spacing will be applied between characters, so
- * the last character will not have spacing applied after it.
- * Note that not all scripts have a letter-spacing tradition,
- * for example, Arabic does not, while Devanagari does.
- *
- * This will also add “disable `liga`, `clig`, `hlig`, `dlig`, and `calt`” font
- * features to the internal features list, so call this function after setting
- * the font features for best spacing results.
+ * @max_entries: maximum number of layouts to cache, or 0 to disable the
+ * cache.
+ * @max_bytes: maximum memory used by the cached layouts in bytes, or 0 for no
+ * limit.
+ *
+ * Enables caching the output of whole paragraphs. When enabled, raqm_layout()
+ * looks up the complete input of @rq, i.e. the text, the faces, their sizes
+ * and transforms, the languages, the letter spacing, the paragraph direction,
+ * the font features and the invisible glyph, and if the same input was laid
+ * out before with @rq, the glyphs from that layout are reused without
+ * itemizing or shaping the text again. This is useful when the same strings
+ * are laid out over and over again, e.g. labels in map rendering.
+ *
+ * The cached layouts keep a reference to the #FT_Face objects used by them,
+ * until they are dropped from the cache or @rq is destroyed. Layouts using
+ * variable fonts (faces with multiple masters) are never cached, since their
+ * variation coordinates can’t be cheaply compared.
+ *
+ * At most @max_entries layouts are kept, and when the cache is full the least
+ * recently used layouts are dropped. Making the cache smaller drops the least
+ * recently used layouts to fit. The cache is disabled by default.
+ *
+ * See also raqm_get_layout_cache_stats().
  *
  * Return value:
  * `true` if no errors happened, `false` otherwise.
  *
- * Since: 0.10
+ * Since: 0.12
  */
 bool
-raqm_set_letter_spacing_range(raqm_t *rq,
-                              int    spacing,
-                              size_t start,
-                              size_t len)
+raqm_set_layout_cache_size (raqm_t *rq,
+                            size_t  max_entries,
+                            size_t  max_bytes)
 {
-  size_t end;
-
   if (!rq)
     return false;
 
-  if (!rq->text_len)
-    return true;
-
-  end = start + len - 1;
-
-  if (spacing != 0)
-  {
-#define NUM_TAGS 5
-    static char *tags[NUM_TAGS] = { "clig", "liga", "hlig", "dlig", "calt" };
-    for (size_t i = 0; i < NUM_TAGS; i++)
-    {
-      hb_feature_t fea = { hb_tag_from_string(tags[i], 5), 0, start, end };
-      _raqm_add_font_feature (rq, fea);
-    }
-#undef NUM_TAGS
-  }
-
-  start = _raqm_encoding_to_u32_index (rq, start);
-  end = _raqm_encoding_to_u32_index (rq, end);
+  return _raqm_cache_resize (&rq->layout_cache, max_entries, max_bytes);
+}
 
-  return _raqm_set_spacing (rq, spacing, false, start, end);
+/**
+ * raqm_get_layout_cache_stats:
+ * @rq: a #raqm_t.
+ * @hits: (out) (optional): number of layouts found in the cache.
+ * @misses: (out) (optional): number of layouts not found in the cache.
+ *
+ * Gets the number of layout cache hits and misses since @rq was created, see
+ * raqm_set_layout_cache_size(). Layouts that can’t be cached are not counted.
+ *
+ * Since: 0.12
+ */
+void
+raqm_get_layout_cache_stats (raqm_t *rq,
+                             size_t *hits,
+                             size_t *misses)
+{
+  if (hits)
+    *hits = rq ? rq->layout_cache.hits : 0;
+  if (misses)
+    *misses = rq ? rq->layout_cache.misses : 0;
 }
 
 /**
- * raqm_set_word_spacing_range:
+ * raqm_save_word_cache:
  * @rq: a #raqm_t.
- * @spacing: amount of spacing in Freetype Font Units (26.6 format).
- * @start: index of the first character that should use @spacing.
- * @len: number of characters using @spacing.
+ * @filename: the file to write.
  *
- * Set the word spacing for a given range. Word spacing will only be applied to
- * 'word separator' characters, such as 'space', 'no break space' and
- * 'Ethiopic word separator'.
- * The value will be added onto the advance and offset for RTL, and the advance
- * for other directions.
+ * Writes the words currently in the word cache of @rq (see
+ * raqm_set_word_cache_size()) to @filename, so that they can be loaded with
+ * raqm_load_word_cache(), e.g. by a later run of the application or by other
+ * processes. If @filename exists, it is replaced.
+ *
+ * Since the file can’t refer to #FT_Face objects, words are stored with a
+ * fingerprint of the font instead, made from its tables and the load flags.
+ * Words shaped with fonts that are not in SFNT format (e.g. TrueType or
+ * OpenType) or with variable fonts are not written.
  *
  * Return value:
  * `true` if no errors happened, `false` otherwise.
  *
- * Since: 0.10
+ * Since: 0.12
  */
 bool
-raqm_set_word_spacing_range(raqm_t *rq,
-                            int    spacing,
-                            size_t start,
-                            size_t len)
+raqm_save_word_cache (raqm_t     *rq,
+                      const char *filename)
 {
-  size_t end;
-
-  if (!rq)
+  if (!rq || !filename)
     return false;
 
-  if (!rq->text_len)
-    return true;
-
-  end = _raqm_encoding_to_u32_index (rq, start + len);
-  start = _raqm_encoding_to_u32_index (rq, start);
-
-  return _raqm_set_spacing (rq, spacing, true, start, end);
+  return _raqm_word_file_write (rq, filename);
 }
 
 /**
- * raqm_set_invisible_glyph:
+ * raqm_load_word_cache:
  * @rq: a #raqm_t.
- * @gid: glyph id to use for invisible glyphs.
- *
- * Sets the glyph id to be used for invisible glyphs.
+ * @filename: a file written by raqm_save_word_cache().
  *
- * If @gid is negative, invisible glyphs will be suppressed from the output.
+ * Loads a word cache file written by raqm_save_word_cache(). Words not found
+ * in the word cache of @rq are then looked up in the file before shaping
+ * them, and words found there are added to the cache. The word cache must be
+ * enabled with raqm_set_word_cache_size() for the file to be used.
  *
- * If @gid is zero, invisible glyphs will be rendered as space.
+ * Where supported, the file is mapped in memory rather than read, and used as
+ * is without parsing, so loading it is fast and processes loading the same
+ * file share its memory. The file must not be modified while loaded, use
+ * raqm_save_word_cache() which replaces the file instead of writing to it.
  *
- * If @gid is a positive number, it will be used for invisible glyphs.
+ * Files written with a different HarfBuzz version, or on a system with a
+ * different byte order, are rejected. Loading a file replaces any file loaded
+ * before, and the file stays loaded until @rq is destroyed.
  *
  * Return value:
- * `true` if no errors happened, `false` otherwise.
+ * `true` if the file was loaded, `false` otherwise.
  *
- * Since: 0.6
+ * Since: 0.12
  */
 bool
-raqm_set_invisible_glyph (raqm_t *rq,
-                          int gid)
+raqm_load_word_cache (raqm_t     *rq,
+                      const char *filename)
 {
-  if (!rq)
+  bool ok;
+
+  if (!rq || !filename)
     return false;
 
-  rq->invisible_glyph = gid;
-  return true;
+  _raqm_word_file_unload (rq);
+
+  ok = false;
+#ifdef HAVE_MMAP
+  ok = _raqm_word_file_map (rq, filename);
+#endif
+  if (!ok)
+    ok = _raqm_word_file_read (rq, filename);
+
+  if (ok && !_raqm_word_file_check (rq))
+  {
+    _raqm_word_file_unload (rq);
+    ok = false;
+  }
+
+  return ok;
 }
 
 static bool
@@ -1306,6 +3898,17 @@ _raqm_itemize (raqm_t *rq);
 static bool
 _raqm_shape (raqm_t *rq);
 
+static bool
+_raqm_layout_cache_build_key (raqm_t *rq);
+
+static bool
+_raqm_layout_cache_restore (raqm_t                   *rq,
+                            const _raqm_layout_entry *entry);
+
+static void
+_raqm_layout_cache_insert (raqm_t  *rq,
+                           uint32_t hash);
+
 static bool
 _raqm_is_paragraph_separator (uint32_t ch)
 {
@@ -1332,31 +3935,62 @@ _raqm_is_paragraph_separator (uint32_t ch)
 bool
 raqm_layout (raqm_t *rq)
 {
+  bool cacheable = false;
+  uint32_t hash = 0;
+
   if (!rq)
     return false;
 
   if (!rq->text_len)
     return true;
 
-  if (!rq->text_info)
+  if (!rq->spans_len)
     return false;
 
-  for (size_t i = 0; i < rq->text_len; i++)
+  for (size_t i = 0; i < rq->spans_len; i++)
   {
-      if (!rq->text_info[i].ftface)
-          return false;
+    if (!rq->spans[i].ftface)
+      return false;
+  }
 
+  for (size_t i = 0; i < rq->text_len; i++)
+  {
       /* The text must be a single paragraph. */
       if (_raqm_is_paragraph_separator (rq->text[i]))
           return false;
   }
 
+  if (rq->layout_cache.max_len && _raqm_layout_cache_build_key (rq))
+  {
+    _raqm_layout_key key = { rq->layout_key, rq->layout_key_len };
+    _raqm_cache_entry *entry;
+
+    hash = _raqm_hash (RAQM_HASH_INIT, key.data, key.len);
+    entry = _raqm_cache_lookup (&rq->layout_cache, hash,
+                                _raqm_layout_entry_equal, &key);
+    if (entry)
+    {
+      rq->layout_cache.hits++;
+      return _raqm_layout_cache_restore (rq, (_raqm_layout_entry *) entry) &&
+             _raqm_index_runs (rq);
+    }
+
+    rq->layout_cache.misses++;
+    cacheable = true;
+  }
+
   if (!_raqm_itemize (rq))
     return false;
 
   if (!_raqm_shape (rq))
     return false;
 
+  if (!_raqm_index_runs (rq))
+    return false;
+
+  if (cacheable)
+    _raqm_layout_cache_insert (rq, hash);
+
   return true;
 }
 
@@ -1387,75 +4021,40 @@ raqm_get_glyphs (raqm_t *rq,
 {
   size_t count = 0;
 
-  if (!rq || !rq->runs || !length)
+  if (!rq || !rq->runs_len || !length)
   {
     if (length)
       *length = 0;
     return NULL;
   }
 
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
-    count += hb_buffer_get_length (run->buffer);
-
-  if (count > rq->glyphs_capacity)
-  {
-    void* new_mem = realloc (rq->glyphs, sizeof (raqm_glyph_t) * count);
-    if (!new_mem)
-    {
-      *length = 0;
-      return NULL;
-    }
-
-    rq->glyphs = new_mem;
-    rq->glyphs_capacity = count;
-  }
-
+  count = rq->glyphs_len;
   *length = count;
 
   RAQM_TEST ("Glyph information:\n");
 
-  count = 0;
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
+#ifdef RAQM_TESTING
+  for (size_t i = 0; i < count; i++)
   {
-    size_t len;
-    hb_glyph_info_t *info;
-    hb_glyph_position_t *position;
-
-    len = hb_buffer_get_length (run->buffer);
-    info = hb_buffer_get_glyph_infos (run->buffer, NULL);
-    position = hb_buffer_get_glyph_positions (run->buffer, NULL);
-
-    for (size_t i = 0; i < len; i++)
-    {
-      rq->glyphs[count + i].index = info[i].codepoint;
-      rq->glyphs[count + i].cluster = info[i].cluster;
-      rq->glyphs[count + i].x_advance = position[i].x_advance;
-      rq->glyphs[count + i].y_advance = position[i].y_advance;
-      rq->glyphs[count + i].x_offset = position[i].x_offset;
-      rq->glyphs[count + i].y_offset = position[i].y_offset;
-      rq->glyphs[count + i].ftface = rq->text_info[info[i].cluster].ftface;
-
-      RAQM_TEST ("glyph [%d]\tx_offset: %d\ty_offset: %d\tx_advance: %d\tfont: %s\n",
-          rq->glyphs[count + i].index, rq->glyphs[count + i].x_offset,
-          rq->glyphs[count + i].y_offset, rq->glyphs[count + i].x_advance,
-          rq->glyphs[count + i].ftface->family_name);
-    }
-
-    count += len;
+    RAQM_TEST ("glyph [%d]\tx_offset: %d\ty_offset: %d\tx_advance: %d\tfont: %s\n",
+        rq->glyphs[i].index, rq->glyphs[i].x_offset,
+        rq->glyphs[i].y_offset, rq->glyphs[i].x_advance,
+        rq->glyphs[i].ftface->family_name);
   }
+#endif
 
   if (rq->text_utf8)
   {
 #ifdef RAQM_TESTING
     RAQM_TEST ("\nUTF-32 clusters:");
     for (size_t i = 0; i < count; i++)
-      RAQM_TEST (" %02d", rq->glyphs[i].cluster);
+      RAQM_TEST (" %02d", rq->glyph_clusters[i]);
     RAQM_TEST ("\n");
 #endif
 
     for (size_t i = 0; i < count; i++)
       rq->glyphs[i].cluster = _raqm_u32_to_u8_index (rq,
-                                                     rq->glyphs[i].cluster);
+                                                     rq->glyph_clusters[i]);
 
 #ifdef RAQM_TESTING
     RAQM_TEST ("UTF-8 clusters: ");
@@ -1468,11 +4067,292 @@ raqm_get_glyphs (raqm_t *rq,
   {
     for (size_t i = 0; i < count; i++)
       rq->glyphs[i].cluster = _raqm_u32_to_u16_index (rq,
-                                                     rq->glyphs[i].cluster);
+                                                      rq->glyph_clusters[i]);
   }
   return rq->glyphs;
 }
 
+/**
+ * raqm_layout_foreach_glyph:
+ * @rq: a #raqm_t.
+ * @func: (scope call): the function to call for each glyph.
+ * @user_data: data to pass to @func.
+ *
+ * Calls @func for each output glyph of the layout, in the same order and
+ * with the same values as in the array returned by raqm_get_glyphs(). This
+ * lets callers that copy the glyphs into their own format do so directly
+ * from the layout.
+ *
+ * The glyph passed to @func is only valid during the call.
+ *
+ * Return value:
+ * `true` if @func was called for all the glyphs, `false` if it stopped the
+ * iteration or in case of error.
+ *
+ * Since: 0.12
+ */
+bool
+raqm_layout_foreach_glyph (raqm_t           *rq,
+                           raqm_glyph_func_t func,
+                           void             *user_data)
+{
+  if (!rq || !rq->runs_len || !func)
+    return false;
+
+  for (size_t i = 0; i < rq->glyphs_len; i++)
+  {
+    raqm_glyph_t glyph = rq->glyphs[i];
+
+    glyph.cluster = _raqm_u32_to_encoding_index (rq, rq->glyph_clusters[i]);
+
+    if (!func (&glyph, user_data))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * raqm_get_glyph_arrays:
+ * @rq: a #raqm_t.
+ * @start: the first glyph to copy.
+ * @length: the size of the output arrays.
+ * @indices: (out) (array length=length) (nullable): output glyph indices.
+ * @x_advances: (out) (array length=length) (nullable): output horizontal
+ * advances.
+ * @y_advances: (out) (array length=length) (nullable): output vertical
+ * advances.
+ * @x_offsets: (out) (array length=length) (nullable): output horizontal
+ * offsets.
+ * @y_offsets: (out) (array length=length) (nullable): output vertical
+ * offsets.
+ * @clusters: (out) (array length=length) (nullable): output clusters.
+ *
+ * Copies the fields of the output glyphs, starting at glyph @start, into
+ * separate arrays provided by the caller. Each array receives the same values
+ * as the matching #raqm_glyph_t field of the array returned by
+ * raqm_get_glyphs(), and any of them can be `NULL` if that field is not
+ * needed. The font of the glyphs is not included, since it only changes
+ * between runs.
+ *
+ * Passing `NULL` for all arrays and `SIZE_MAX` for @length gives the number
+ * of glyphs after @start.
+ *
+ * Return value:
+ * The number of glyphs copied, at most @length, or 0 in case of error.
+ *
+ * Since: 0.12
+ */
+size_t
+raqm_get_glyph_arrays (raqm_t       *rq,
+                       size_t        start,
+                       size_t        length,
+                       unsigned int *indices,
+                       int          *x_advances,
+                       int          *y_advances,
+                       int          *x_offsets,
+                       int          *y_offsets,
+                       uint32_t     *clusters)
+{
+  const raqm_glyph_t *glyphs;
+  size_t count;
+
+  if (!rq || !rq->runs_len || start >= rq->glyphs_len)
+    return 0;
+
+  glyphs = rq->glyphs + start;
+  count = rq->glyphs_len - start;
+  if (count > length)
+    count = length;
+
+  /* One loop per array, so that each one is a plain strided copy. */
+  if (indices)
+    for (size_t i = 0; i < count; i++)
+      indices[i] = glyphs[i].index;
+  if (x_advances)
+    for (size_t i = 0; i < count; i++)
+      x_advances[i] = glyphs[i].x_advance;
+  if (y_advances)
+    for (size_t i = 0; i < count; i++)
+      y_advances[i] = glyphs[i].y_advance;
+  if (x_offsets)
+    for (size_t i = 0; i < count; i++)
+      x_offsets[i] = glyphs[i].x_offset;
+  if (y_offsets)
+    for (size_t i = 0; i < count; i++)
+      y_offsets[i] = glyphs[i].y_offset;
+
+  if (clusters)
+    for (size_t i = 0; i < count; i++)
+      clusters[i] = _raqm_u32_to_encoding_index (rq,
+                                                 rq->glyph_clusters[start + i]);
+
+  return count;
+}
+
+/* Rounds @value to the nearest multiple of @grid, halves up, and clamps it
+ * to the range of int. */
+static int
+_raqm_snap_to_grid (int64_t value,
+                    int     grid)
+{
+  if (grid > 1)
+  {
+    int64_t rem;
+
+    value += grid / 2;
+    rem = value % grid;
+    if (rem < 0)
+      rem += grid;
+    value -= rem;
+  }
+
+  if (value > INT_MAX)
+    return INT_MAX;
+  if (value < INT_MIN)
+    return INT_MIN;
+  return value;
+}
+
+/**
+ * raqm_get_glyph_positions:
+ * @rq: a #raqm_t.
+ * @start: the first glyph to position.
+ * @length: the size of the output arrays.
+ * @x: (inout) (nullable): the horizontal pen position.
+ * @y: (inout) (nullable): the vertical pen position.
+ * @x_positions: (out) (array length=length) (nullable): output horizontal
+ * positions.
+ * @y_positions: (out) (array length=length) (nullable): output vertical
+ * positions.
+ * @grid: the grid to snap the positions to, or 0 for none.
+ *
+ * Computes the absolute position of each output glyph, starting at glyph
+ * @start. The position of a glyph is the pen position plus its offset, and
+ * the pen then moves by its advance, in the same units as the advances in the
+ * array returned by raqm_get_glyphs(), so it is where the glyph should be
+ * drawn.
+ *
+ * The pen starts at @x and @y, and they are set to its position after the
+ * last glyph, so that positioning the glyphs in chunks only needs to pass the
+ * same variables again with the next @start. Start them at 0, or pass `NULL`,
+ * for positions relative to the start of the line.
+ *
+ * If @grid is larger than one, each position is rounded to the nearest
+ * multiple of it, e.g. 64 to snap 26.6 fixed point positions to whole pixels.
+ * The pen itself is not rounded, so rounding errors do not add up along the
+ * line. Positions out of the range of int are clamped.
+ *
+ * Return value:
+ * The number of glyphs positioned, at most @length, or 0 in case of error.
+ *
+ * Since: 0.12
+ */
+size_t
+raqm_get_glyph_positions (raqm_t  *rq,
+                          size_t   start,
+                          size_t   length,
+                          int64_t *x,
+                          int64_t *y,
+                          int     *x_positions,
+                          int     *y_positions,
+                          int      grid)
+{
+  const raqm_glyph_t *glyphs;
+  int64_t pen_x = x ? *x : 0;
+  int64_t pen_y = y ? *y : 0;
+  size_t count;
+
+  if (!rq || !rq->runs_len || start >= rq->glyphs_len || grid < 0)
+    return 0;
+
+  glyphs = rq->glyphs + start;
+  count = rq->glyphs_len - start;
+  if (count > length)
+    count = length;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    if (x_positions)
+      x_positions[i] = _raqm_snap_to_grid (pen_x + glyphs[i].x_offset, grid);
+    if (y_positions)
+      y_positions[i] = _raqm_snap_to_grid (pen_y + glyphs[i].y_offset, grid);
+    pen_x += glyphs[i].x_advance;
+    pen_y += glyphs[i].y_advance;
+  }
+
+  if (x)
+    *x = pen_x;
+  if (y)
+    *y = pen_y;
+
+  return count;
+}
+
+static raqm_direction_t
+_raqm_direction_from_hb (hb_direction_t dir)
+{
+  switch (dir)
+  {
+    case HB_DIRECTION_LTR:
+      return RAQM_DIRECTION_LTR;
+    case HB_DIRECTION_RTL:
+      return RAQM_DIRECTION_RTL;
+    case HB_DIRECTION_TTB:
+      return RAQM_DIRECTION_TTB;
+    default:
+      return RAQM_DIRECTION_DEFAULT;
+  }
+}
+
+/**
+ * raqm_get_runs:
+ * @rq: a #raqm_t.
+ * @runs: (out) (array length=max_runs) (nullable): array to fill with the
+ * runs.
+ * @max_runs: the number of elements @runs can hold.
+ *
+ * Gets the runs the text was split into for shaping, in visual order. Each
+ * run has a single direction, script, language and font, and covers a
+ * contiguous range of the glyphs returned by raqm_get_glyphs(), so renderers
+ * can handle the glyphs one font at a time. At most @max_runs of them are
+ * stored.
+ *
+ * Return value:
+ * The total number of runs, which may be larger than @max_runs, or 0 if
+ * raqm_layout() has not been called on @rq. Pass `NULL` and 0 to only get
+ * the number.
+ *
+ * Since: 0.12
+ */
+size_t
+raqm_get_runs (raqm_t          *rq,
+               raqm_run_info_t *runs,
+               size_t           max_runs)
+{
+  if (!rq || !rq->runs_len)
+    return 0;
+
+  for (size_t i = 0; i < rq->runs_len && i < max_runs; i++)
+  {
+    const raqm_run_t *run = &rq->runs[i];
+    const _raqm_text_span *span = &rq->spans[_raqm_find_span (rq, run->pos, 0)];
+    size_t start = _raqm_u32_to_encoding_index (rq, run->pos);
+    size_t end = _raqm_u32_to_encoding_index (rq, run->pos + run->len);
+
+    runs[i].start = start;
+    runs[i].length = end - start;
+    runs[i].direction = _raqm_direction_from_hb (run->direction);
+    runs[i].script = run->script;
+    runs[i].language = hb_language_to_string (span->lang);
+    runs[i].ftface = span->ftface;
+    runs[i].glyphs_start = run->glyphs_start;
+    runs[i].glyphs_len = run->glyphs_len;
+  }
+
+  return rq->runs_len;
+}
+
 /**
  * raqm_get_par_resolved_direction:
  * @rq: a #raqm_t.
@@ -1543,26 +4423,14 @@ raqm_direction_t
 raqm_get_direction_at_index (raqm_t *rq,
                              size_t index)
 {
+  const raqm_run_t *run;
+
   if (!rq)
     return RAQM_DIRECTION_DEFAULT;
 
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
-  {
-    if (run->pos <= index && index < run->pos + run->len)
-    {
-      switch (run->direction)
-      {
-        case HB_DIRECTION_LTR:
-          return RAQM_DIRECTION_LTR;
-        case HB_DIRECTION_RTL:
-          return RAQM_DIRECTION_RTL;
-        case HB_DIRECTION_TTB:
-          return RAQM_DIRECTION_TTB;
-        default:
-          return RAQM_DIRECTION_DEFAULT;
-      }
-    }
-  }
+  run = _raqm_find_run (rq, index);
+  if (run)
+    return _raqm_direction_from_hb (run->direction);
 
   return RAQM_DIRECTION_DEFAULT;
 }
@@ -1626,7 +4494,7 @@ _raqm_bidi_itemize (raqm_t *rq, size_t *run_count)
   else
     rq->resolved_dir = RAQM_DIRECTION_LTR;
 
-  runs = malloc (sizeof (_raqm_bidi_run) * (*run_count));
+  runs = _raqm_arena_alloc (rq, sizeof (_raqm_bidi_run) * (*run_count));
   if (runs)
   {
     const SBRun *sheenbidi_runs = SBLineGetRunsPtr(line);
@@ -1685,7 +4553,8 @@ _raqm_reverse_run (_raqm_bidi_run *run, const size_t len)
 }
 
 static _raqm_bidi_run *
-_raqm_reorder_runs (const FriBidiCharType *types,
+_raqm_reorder_runs (raqm_t                *rq,
+                    const FriBidiCharType *types,
                     const size_t len,
                     const FriBidiParType base_dir,
                     /* input and output */
@@ -1735,7 +4604,7 @@ _raqm_reorder_runs (const FriBidiCharType *types,
     last_level = levels[i];
   }
 
-  runs = malloc (sizeof (_raqm_bidi_run) * count);
+  runs = _raqm_arena_alloc (rq, sizeof (_raqm_bidi_run) * count);
   if (!runs)
   {
     *run_count = 0;
@@ -1787,12 +4656,12 @@ _raqm_bidi_itemize (raqm_t *rq, size_t *run_count)
   int max_level = 0;
   FriBidiBracketType *btypes;
 
-  types = calloc (rq->text_len, sizeof (FriBidiCharType));
-  btypes = calloc (rq->text_len, sizeof (FriBidiBracketType));
-  levels = calloc (rq->text_len, sizeof (_raqm_bidi_level_t));
+  types = _raqm_arena_alloc (rq, sizeof (FriBidiCharType) * rq->text_len);
+  btypes = _raqm_arena_alloc (rq, sizeof (FriBidiBracketType) * rq->text_len);
+  levels = _raqm_arena_alloc (rq, sizeof (_raqm_bidi_level_t) * rq->text_len);
 
   if (!types || !levels || !btypes)
-    goto done;
+    return NULL;
 
   if (rq->base_dir == RAQM_DIRECTION_RTL)
     par_type = FRIBIDI_PAR_RTL;
@@ -1811,15 +4680,11 @@ _raqm_bidi_itemize (raqm_t *rq, size_t *run_count)
     rq->resolved_dir = RAQM_DIRECTION_LTR;
 
   if (max_level == 0)
-    goto done;
+    return NULL;
 
   /* Get the number of bidi runs */
-  runs = _raqm_reorder_runs (types, rq->text_len, par_type, levels, run_count);
-
-done:
-  free (types);
-  free (levels);
-  free (btypes);
+  runs = _raqm_reorder_runs (rq, types, rq->text_len, par_type, levels,
+                             run_count);
 
   return runs;
 }
@@ -1831,7 +4696,7 @@ _raqm_detect_direction (raqm_t *rq)
   FriBidiParType par_type;
   FriBidiCharType *types;
 
-  types = calloc (rq->text_len, sizeof (FriBidiCharType));
+  types = _raqm_calloc (&rq->allocator, rq->text_len, sizeof (FriBidiCharType));
   if (types)
   {
     fribidi_get_bidi_types (rq->text, rq->text_len, types);
@@ -1842,7 +4707,7 @@ _raqm_detect_direction (raqm_t *rq)
     else if (par_type == FRIBIDI_PAR_RTL)
       dir = RAQM_DIRECTION_RTL;
 
-    free (types);
+    _raqm_free (&rq->allocator, types);
   }
 
   return dir;
@@ -1853,7 +4718,8 @@ static bool
 _raqm_itemize (raqm_t *rq)
 {
   _raqm_bidi_run *runs = NULL;
-  raqm_run_t *last;
+  const _raqm_text_span *run_span;
+  size_t span = 0;
   size_t run_count = 0;
   bool ok = true;
 
@@ -1880,7 +4746,7 @@ _raqm_itemize (raqm_t *rq)
     /* Treat every thing as LTR in vertical text */
     run_count = 1;
     rq->resolved_dir = RAQM_DIRECTION_TTB;
-    runs = malloc (sizeof (_raqm_bidi_run));
+    runs = _raqm_arena_alloc (rq, sizeof (_raqm_bidi_run));
     if (runs)
     {
       runs->pos = 0;
@@ -1912,114 +4778,85 @@ _raqm_itemize (raqm_t *rq)
   RAQM_TEST ("\n");
 #endif
 
-  last = NULL;
+  /* Split each BiDi run on script and font boundaries in one pass over its
+   * characters, following the spans along. The runs are kept in visual order,
+   * so the pieces of a backward run are reversed once it is done. */
+  _raqm_reset_runs (rq);
   for (size_t i = 0; i < run_count; i++)
   {
-    raqm_run_t *run = _raqm_alloc_run (rq);
-    if (!run)
-    {
-      ok = false;
-      goto done;
-    }
-
-    if (!rq->runs)
-      rq->runs = run;
+    hb_direction_t direction = _raqm_hb_dir (rq, runs[i].level);
+    size_t end = runs[i].pos + runs[i].len;
+    size_t first = rq->runs_len;
+    size_t span_end;
 
-    if (last)
-      last->next = run;
+    span = _raqm_find_span (rq, runs[i].pos, span);
+    span_end = _raqm_span_end (rq, span);
 
-    run->direction = _raqm_hb_dir (rq, runs[i].level);
-
-    if (HB_DIRECTION_IS_BACKWARD (run->direction))
+    for (size_t pos = runs[i].pos; pos < end;)
     {
-      run->pos = runs[i].pos + runs[i].len - 1;
-      run->script = rq->text_info[run->pos].script;
-      run->font = _raqm_create_hb_font (rq, rq->text_info[run->pos].ftface,
-          rq->text_info[run->pos].ftloadflags);
-      for (int j = runs[i].len - 1; j >= 0; j--)
+      size_t run_end = pos + 1;
+      raqm_run_t *run;
+
+      run_span = &rq->spans[span];
+      while (run_end < end)
       {
-        _raqm_text_info info = rq->text_info[runs[i].pos + j];
-        if (!_raqm_compare_text_info (rq->text_info[run->pos], info))
+        if (run_end == span_end)
         {
-          raqm_run_t *newrun = _raqm_alloc_run (rq);
-          if (!newrun)
-          {
-            ok = false;
-            goto done;
-          }
-          newrun->pos = runs[i].pos + j;
-          newrun->len = 1;
-          newrun->direction = _raqm_hb_dir (rq, runs[i].level);
-          newrun->script = info.script;
-          newrun->font = _raqm_create_hb_font (rq, info.ftface,
-              info.ftloadflags);
-          run->next = newrun;
-          run = newrun;
-        }
-        else
-        {
-          run->len++;
-          run->pos = runs[i].pos + j;
+          span++;
+          span_end = _raqm_span_end (rq, span);
+          if (!_raqm_span_same_font (run_span, &rq->spans[span]))
+            break;
         }
+        if (rq->scripts[run_end] != rq->scripts[pos])
+          break;
+        run_end++;
+      }
+
+      run = _raqm_add_run (rq);
+      if (!run)
+      {
+        ok = false;
+        goto done;
       }
+
+      run->pos = pos;
+      run->len = run_end - pos;
+      run->direction = direction;
+      run->script = rq->scripts[pos];
+      run->font = _raqm_get_hb_font (rq, run_span->ftface,
+          run_span->ftloadflags);
+
+      pos = run_end;
     }
-    else
+
+    if (HB_DIRECTION_IS_BACKWARD (direction))
     {
-      run->pos = runs[i].pos;
-      run->script = rq->text_info[run->pos].script;
-      run->font = _raqm_create_hb_font (rq, rq->text_info[run->pos].ftface,
-          rq->text_info[run->pos].ftloadflags);
-      for (size_t j = 0; j < runs[i].len; j++)
+      for (size_t j = first, k = rq->runs_len - 1; j < k; j++, k--)
       {
-        _raqm_text_info info = rq->text_info[runs[i].pos + j];
-        if (!_raqm_compare_text_info (rq->text_info[run->pos], info))
-        {
-          raqm_run_t *newrun = _raqm_alloc_run (rq);
-          if (!newrun)
-          {
-            ok = false;
-            goto done;
-          }
-          newrun->pos = runs[i].pos + j;
-          newrun->len = 1;
-          newrun->direction = _raqm_hb_dir (rq, runs[i].level);
-          newrun->script = info.script;
-          newrun->font = _raqm_create_hb_font (rq, info.ftface,
-              info.ftloadflags);
-          run->next = newrun;
-          run = newrun;
-        }
-        else
-          run->len++;
+        raqm_run_t temp = rq->runs[j];
+        rq->runs[j] = rq->runs[k];
+        rq->runs[k] = temp;
       }
     }
-
-    last = run;
-    last->next = NULL;
   }
 
 #ifdef RAQM_TESTING
-  run_count = 0;
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
-    run_count++;
-  RAQM_TEST ("Number of runs after script itemization: %zu\n\n", run_count);
+  RAQM_TEST ("Number of runs after script itemization: %zu\n\n", rq->runs_len);
 
-  run_count = 0;
   RAQM_TEST ("Final Runs:\n");
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
+  for (size_t i = 0; i < rq->runs_len; i++)
   {
+    const raqm_run_t *run = &rq->runs[i];
     SCRIPT_TO_STRING (run->script);
     RAQM_TEST ("run[%zu]:\t start: %d\tlength: %d\tdirection: %s\tscript: %s\tfont: %s\n",
-               run_count++, run->pos, run->len,
+               i, run->pos, run->len,
                hb_direction_to_string (run->direction), buff,
-               rq->text_info[run->pos].ftface->family_name);
+               rq->spans[_raqm_find_span (rq, run->pos, 0)].ftface->family_name);
   }
   RAQM_TEST ("\n");
 #endif
 
 done:
-  free (runs);
-
   return ok;
 }
 
@@ -2055,36 +4892,24 @@ static const uint32_t paired_chars[] =
   0x301a, 0x301b
 };
 
-static void
-_raqm_stack_free (_raqm_stack_t *stack)
-{
-  free (stack->script);
-  free (stack->pair_index);
-  free (stack);
-}
-
 /* Stack handling functions */
 static _raqm_stack_t *
-_raqm_stack_new (size_t max)
+_raqm_stack_new (raqm_t *rq,
+                 size_t  max)
 {
   _raqm_stack_t *stack;
-  stack = calloc (1, sizeof (_raqm_stack_t));
+  stack = _raqm_arena_alloc (rq, sizeof (_raqm_stack_t));
   if (!stack)
     return NULL;
 
-  stack->script = malloc (sizeof (hb_script_t) * max);
+  /* Items are stored from index 1 */
+  stack->script = _raqm_arena_alloc (rq, sizeof (hb_script_t) * (max + 1));
   if (!stack->script)
-  {
-    _raqm_stack_free (stack);
     return NULL;
-  }
 
-  stack->pair_index = malloc (sizeof (int) * max);
+  stack->pair_index = _raqm_arena_alloc (rq, sizeof (int) * (max + 1));
   if (!stack->pair_index)
-  {
-    _raqm_stack_free (stack);
     return NULL;
-  }
 
   stack->size = 0;
   stack->capacity = max;
@@ -2159,12 +4984,29 @@ _get_pair_index (const uint32_t ch)
 #define STACK_IS_EMPTY(script)     ((script)->size <= 0)
 #define IS_OPEN(pair_index)        (((pair_index) & 1) == 0)
 
-static hb_script_t
-_raqm_unicode_script (hb_codepoint_t u)
+/* Returns the merged grapheme properties of @u, taking Latin-1 characters
+ * from the direct page and the rest from the packed trie. */
+static inline uint8_t
+_raqm_get_props (hb_codepoint_t u)
 {
-  static hb_unicode_funcs_t* unicode_funcs;
+  if (u < 0x100)
+    return _raqm_latin1_props[u];
+  return _raqm_get_grapheme_props (u);
+}
 
-  unicode_funcs = hb_unicode_funcs_get_default ();
+#define RAQM_PROPS_GRAPHEME(props) ((_raqm_grapheme_t) ((props) & 0x0F))
+#define RAQM_PROPS_INCB(props) ((_raqm_incb_t) (((props) >> RAQM_INCB_SHIFT) & 0x03))
+
+static hb_script_t
+_raqm_unicode_script (hb_unicode_funcs_t *unicode_funcs,
+                      hb_codepoint_t      u)
+{
+  /* Latin-1 has no combining marks, and its characters are all either Latin
+   * or Common, so they don't need to go through HarfBuzz.
+   */
+  if (u < 0x100)
+    return _raqm_latin1_props[u] & RAQM_LATIN1_SCRIPT_LATIN ?
+           HB_SCRIPT_LATIN : HB_SCRIPT_COMMON;
 
   /* Make combining marks inherit the script of their bases, regardless of
    * their own script.
@@ -2177,37 +5019,41 @@ _raqm_unicode_script (hb_codepoint_t u)
 
 /* Resolve the script for each character in the input string, if the character
  * script is common or inherited it takes the script of the character before it
- * except paired characters which we try to make them use the same script. We
- * then split the BiDi runs, if necessary, on script boundaries.
+ * except paired characters which we try to make them use the same script.
+ * Common or inherited characters left at the start of the text (or after a
+ * closing paired character that matched one there) take the script of the
+ * first character after them that has a real one. This is all done in one
+ * pass over the text; the BiDi runs are then split, if necessary, on script
+ * boundaries.
  */
 static bool
 _raqm_resolve_scripts (raqm_t *rq)
 {
-  int last_script_index = -1;
-  int last_set_index = -1;
+  bool have_script = false;
+  size_t pending = 0;
   hb_script_t last_script = HB_SCRIPT_INVALID;
   _raqm_stack_t *stack = NULL;
-
-  for (size_t i = 0; i < rq->text_len; ++i)
-    rq->text_info[i].script = _raqm_unicode_script (rq->text[i]);
+  hb_unicode_funcs_t *unicode_funcs = hb_unicode_funcs_get_default ();
 
 #ifdef RAQM_TESTING
   RAQM_TEST ("Before script detection:\n");
   for (size_t i = 0; i < rq->text_len; ++i)
   {
-    SCRIPT_TO_STRING (rq->text_info[i].script);
+    SCRIPT_TO_STRING (_raqm_unicode_script (unicode_funcs, rq->text[i]));
     RAQM_TEST ("script for ch[%zu]\t%s\n", i, buff);
   }
   RAQM_TEST ("\n");
 #endif
 
-  stack = _raqm_stack_new (rq->text_len);
+  stack = _raqm_stack_new (rq, rq->text_len);
   if (!stack)
     return false;
 
-  for (int i = 0; i < (int) rq->text_len; i++)
+  for (size_t i = 0; i < rq->text_len; i++)
   {
-    if (rq->text_info[i].script == HB_SCRIPT_COMMON && last_script_index != -1)
+    rq->scripts[i] = _raqm_unicode_script (unicode_funcs, rq->text[i]);
+
+    if (rq->scripts[i] == HB_SCRIPT_COMMON && have_script)
     {
       int pair_index = _get_pair_index (rq->text[i]);
       if (pair_index >= 0)
@@ -2215,9 +5061,8 @@ _raqm_resolve_scripts (raqm_t *rq)
         if (IS_OPEN (pair_index))
         {
           /* is a paired character */
-          rq->text_info[i].script = last_script;
-          last_set_index = i;
-          _raqm_stack_push (stack, rq->text_info[i].script, pair_index);
+          rq->scripts[i] = last_script;
+          _raqm_stack_push (stack, rq->scripts[i], pair_index);
         }
         else
         {
@@ -2231,62 +5076,51 @@ _raqm_resolve_scripts (raqm_t *rq)
           }
           if (!STACK_IS_EMPTY (stack))
           {
-            rq->text_info[i].script = _raqm_stack_top (stack);
-            last_script = rq->text_info[i].script;
-            last_set_index = i;
+            rq->scripts[i] = _raqm_stack_top (stack);
+            last_script = rq->scripts[i];
           }
           else
-          {
-            rq->text_info[i].script = last_script;
-            last_set_index = i;
-          }
+            rq->scripts[i] = last_script;
         }
       }
       else
-      {
-        rq->text_info[i].script = last_script;
-        last_set_index = i;
-      }
+        rq->scripts[i] = last_script;
     }
-    else if (rq->text_info[i].script == HB_SCRIPT_INHERITED &&
-             last_script_index != -1)
+    else if (rq->scripts[i] == HB_SCRIPT_INHERITED && have_script)
+      rq->scripts[i] = last_script;
+    else
     {
-      rq->text_info[i].script = last_script;
-      last_set_index = i;
+      last_script = rq->scripts[i];
+      have_script = true;
     }
-    else
+
+    /* Common or Inherited characters still waiting for a script take the
+     * one of the next character that has it.
+     * https://github.com/HOST-Oman/libraqm/issues/95
+     */
+    if (rq->scripts[i] != HB_SCRIPT_INHERITED &&
+        rq->scripts[i] != HB_SCRIPT_COMMON)
     {
-      for (int j = last_set_index + 1; j < i; ++j)
-        rq->text_info[j].script = rq->text_info[i].script;
-      last_script = rq->text_info[i].script;
-      last_script_index = i;
-      last_set_index = i;
+      for (; pending < i; pending++)
+        rq->scripts[pending] = rq->scripts[i];
+      pending = i + 1;
     }
   }
 
-  /* Loop backwards and change any remaining Common or Inherit characters to
-   * take the script if the next character.
-   * https://github.com/HOST-Oman/libraqm/issues/95
-   */
-  for (int i = rq->text_len - 2; i >= 0;  --i)
-  {
-    if (rq->text_info[i].script == HB_SCRIPT_INHERITED ||
-        rq->text_info[i].script == HB_SCRIPT_COMMON)
-      rq->text_info[i].script = rq->text_info[i + 1].script;
-  }
+  /* The ones at the end of the text take the script of the last character. */
+  for (; pending + 1 < rq->text_len; pending++)
+    rq->scripts[pending] = rq->scripts[rq->text_len - 1];
 
 #ifdef RAQM_TESTING
   RAQM_TEST ("After script detection:\n");
   for (size_t i = 0; i < rq->text_len; ++i)
   {
-    SCRIPT_TO_STRING (rq->text_info[i].script);
+    SCRIPT_TO_STRING (rq->scripts[i]);
     RAQM_TEST ("script for ch[%zu]\t%s\n", i, buff);
   }
   RAQM_TEST ("\n");
 #endif
 
-  _raqm_stack_free (stack);
-
   return true;
 }
 
@@ -2305,98 +5139,648 @@ _raqm_ft_transform (int      *x,
   *y = vector.y;
 }
 
-#if !HB_VERSION_ATLEAST (10, 4, 0)
-# define hb_ft_font_get_ft_face hb_ft_font_get_face
-#endif
+/* A shape plan depends only on the tags and values of the features, and on
+ * whether they are global or not, so the ranges of non-global features are
+ * normalized away. */
+static hb_feature_t
+_raqm_normalize_feature (hb_feature_t fea)
+{
+  if (fea.start != HB_FEATURE_GLOBAL_START || fea.end != HB_FEATURE_GLOBAL_END)
+  {
+    fea.start = HB_FEATURE_GLOBAL_START;
+    fea.end = HB_FEATURE_GLOBAL_START + 1;
+  }
+
+  return fea;
+}
 
 static bool
-_raqm_shape (raqm_t *rq)
+_raqm_shape_plan_entry_equal (const _raqm_shape_plan_entry  *entry,
+                              const hb_face_t               *face,
+                              const hb_segment_properties_t *props,
+                              const hb_feature_t            *features,
+                              size_t                         features_len)
+{
+  if (entry->face != face ||
+      entry->features_len != features_len ||
+      !hb_segment_properties_equal (&entry->props, props))
+    return false;
+
+  for (size_t i = 0; i < features_len; i++)
+  {
+    hb_feature_t fea = _raqm_normalize_feature (features[i]);
+    if (memcmp (&entry->features[i], &fea, sizeof (hb_feature_t)) != 0)
+      return false;
+  }
+
+  return true;
+}
+
+/* Returns the shape plan for shaping @buffer with @font and @features, or
+ * `NULL` if it can’t be cached.
+ *
+ * Plans are cached on the raqm_t in most recently used order, so that they
+ * are compiled once per configuration instead of once per run. HarfBuzz does
+ * cache plans itself, but not for features with ranges (like the ones added
+ * by raqm_set_letter_spacing_range()). */
+static hb_shape_plan_t *
+_raqm_get_shape_plan (raqm_t             *rq,
+                      hb_font_t          *font,
+                      hb_buffer_t        *buffer,
+                      const hb_feature_t *features,
+                      size_t              features_len)
+{
+  _raqm_shape_plan_entry entry;
+  hb_face_t *face = hb_font_get_face (font);
+  hb_segment_properties_t props;
+  unsigned int num_coords = 0;
+  size_t i;
+
+  /* Plans of variable fonts depend also on the variation coordinates, leave
+   * these to HarfBuzz. */
+  hb_font_get_var_coords_normalized (font, &num_coords);
+  if (num_coords)
+    return NULL;
+
+  hb_buffer_get_segment_properties (buffer, &props);
+
+  for (i = 0; i < rq->plans_len; i++)
+  {
+    if (_raqm_shape_plan_entry_equal (&rq->plans[i], face, &props,
+                                      features, features_len))
+      break;
+  }
+
+  if (i < rq->plans_len)
+  {
+    entry = rq->plans[i];
+  }
+  else
+  {
+    entry.features = NULL;
+    if (features_len)
+    {
+      entry.features = _raqm_malloc (&rq->allocator,
+                                     sizeof (hb_feature_t) * features_len);
+      if (!entry.features)
+        return NULL;
+    }
+
+    for (size_t j = 0; j < features_len; j++)
+      entry.features[j] = _raqm_normalize_feature (features[j]);
+
+    entry.plan = hb_shape_plan_create (face, &props, entry.features,
+                                       features_len, NULL);
+    entry.face = hb_face_reference (face);
+    entry.props = props;
+    entry.features_len = features_len;
+
+    if (rq->plans_len == RAQM_SHAPE_PLAN_CACHE_SIZE)
+      _raqm_free_shape_plan_entry (rq, &rq->plans[--rq->plans_len]);
+
+    i = rq->plans_len++;
+  }
+
+  /* Move to front */
+  memmove (rq->plans + 1, rq->plans, sizeof (_raqm_shape_plan_entry) * i);
+  rq->plans[0] = entry;
+
+  return entry.plan;
+}
+
+static void
+_raqm_hb_shape (raqm_t             *rq,
+                hb_font_t          *font,
+                hb_buffer_t        *buffer,
+                const hb_feature_t *features,
+                size_t              features_len)
+{
+  hb_shape_plan_t *plan;
+
+  if (!hb_buffer_get_length (buffer))
+    return;
+
+  plan = _raqm_get_shape_plan (rq, font, buffer, features, features_len);
+  if (plan)
+    hb_shape_plan_execute (plan, font, buffer, features, features_len);
+  else
+    hb_shape_full (font, buffer, features, features_len, NULL);
+}
+
+static hb_buffer_flags_t
+_raqm_get_buffer_flags (raqm_t *rq)
 {
-  hb_buffer_flags_t hb_buffer_flags = HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT;
+  hb_buffer_flags_t flags = HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT;
 
   if (rq->invisible_glyph < 0)
-    hb_buffer_flags |= HB_BUFFER_FLAG_REMOVE_DEFAULT_IGNORABLES;
+    flags |= HB_BUFFER_FLAG_REMOVE_DEFAULT_IGNORABLES;
+
+  return flags;
+}
+
+static void
+_raqm_setup_buffer (raqm_t           *rq,
+                    hb_buffer_t      *buffer,
+                    raqm_run_t       *run,
+                    hb_buffer_flags_t flags)
+{
+  hb_buffer_set_script (buffer, run->script);
+  hb_buffer_set_language (buffer,
+                          rq->spans[_raqm_find_span (rq, run->pos, 0)].lang);
+  hb_buffer_set_direction (buffer, run->direction);
+  hb_buffer_set_flags (buffer, flags);
+
+  if (rq->invisible_glyph > 0)
+    hb_buffer_set_invisible_glyph (buffer, rq->invisible_glyph);
+}
+
+/* Collects the features that apply to the word from @start to @end, as global
+ * features. Returns false if some feature applies only to part of the word,
+ * in which case the word can’t be cached. */
+static bool
+_raqm_word_features (raqm_t       *rq,
+                     size_t        start,
+                     size_t        end,
+                     hb_feature_t *features,
+                     size_t       *features_len)
+{
+  size_t len = 0;
 
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
+  for (size_t i = 0; i < rq->features_len; i++)
   {
-    if (!run->buffer)
-      run->buffer = hb_buffer_create ();
+    hb_feature_t fea = rq->features[i];
 
-    hb_buffer_add_utf32 (run->buffer, rq->text, rq->text_len,
-                         run->pos, run->len);
-    hb_buffer_set_script (run->buffer, run->script);
-    hb_buffer_set_language (run->buffer, rq->text_info[run->pos].lang);
-    hb_buffer_set_direction (run->buffer, run->direction);
-    hb_buffer_set_flags (run->buffer, hb_buffer_flags);
+    if (fea.end <= start || fea.start >= end)
+      continue;
+
+    if (fea.start > start || fea.end < end)
+      return false;
+
+    fea.start = HB_FEATURE_GLOBAL_START;
+    fea.end = HB_FEATURE_GLOBAL_END;
+    features[len++] = fea;
+  }
 
-    if (rq->invisible_glyph > 0)
-      hb_buffer_set_invisible_glyph (run->buffer, rq->invisible_glyph);
+  *features_len = len;
+  return true;
+}
 
-    hb_shape_full (run->font, run->buffer, rq->features, rq->features_len,
-                   NULL);
+/* Shapes @run word by word, using the word cache. Words are split at spaces,
+ * with each sequence of spaces being a word of its own, and are shaped without
+ * the surrounding context so that their glyphs can be reused wherever the
+ * same word appears again. */
+static bool
+_raqm_shape_words (raqm_t           *rq,
+                   raqm_run_t       *run,
+                   hb_buffer_flags_t flags,
+                   hb_feature_t     *features)
+{
+  bool backward = HB_DIRECTION_IS_BACKWARD (run->direction);
+  size_t start = run->pos;
+  size_t end = run->pos + run->len;
+  hb_buffer_t *buffer = rq->shape_buffer;
+  unsigned int num_coords = 0;
+  _raqm_word_key key;
+
+  /* Variable fonts keep the same HarfBuzz font when their coordinates
+   * change, and the key would not tell instances apart, so they are not
+   * cached. */
+  hb_font_get_var_coords_normalized (run->font, &num_coords);
+
+  key.font = run->font;
+  hb_font_get_scale (run->font, &key.x_scale, &key.y_scale);
+  key.script = run->script;
+  key.lang = rq->spans[_raqm_find_span (rq, run->pos, 0)].lang;
+  key.direction = run->direction;
+  key.flags = flags;
+  key.invisible_glyph = rq->invisible_glyph;
+  key.features = features;
+
+  while (start < end)
+  {
+    size_t word_start, word_end;
+    _raqm_word_entry *entry = NULL;
+    hb_glyph_info_t *info;
+    hb_glyph_position_t *pos;
+    unsigned int len;
+    bool cacheable;
 
+    /* Glyphs of backward runs are in reverse order, so walk them from the
+     * end. */
+    if (backward)
     {
-      FT_Matrix matrix;
-      hb_glyph_info_t *info;
-      hb_glyph_position_t *pos;
-      unsigned int len;
+      bool space = rq->text[end - 1] == 0x0020;
+      word_end = end;
+      word_start = end - 1;
+      while (word_start > start && (rq->text[word_start - 1] == 0x0020) == space)
+        word_start--;
+      end = word_start;
+    }
+    else
+    {
+      bool space = rq->text[start] == 0x0020;
+      word_start = start;
+      word_end = start + 1;
+      while (word_end < end && (rq->text[word_end] == 0x0020) == space)
+        word_end++;
+      start = word_end;
+    }
+
+    key.text = rq->text + word_start;
+    key.text_len = word_end - word_start;
+
+    cacheable = !num_coords &&
+                key.text_len <= RAQM_WORD_CACHE_MAX_WORD_LEN &&
+                _raqm_word_features (rq, word_start, word_end,
+                                     features, &key.features_len);
+
+    hb_buffer_clear_contents (buffer);
+    _raqm_setup_buffer (rq, buffer, run, flags);
+
+    if (cacheable)
+    {
+      key.hash = _raqm_word_key_hash (&key);
+      entry = _raqm_word_cache_lookup (&rq->word_cache, &key);
+    }
+
+    /* Words found in the cache file count as hits too */
+    if (entry)
+    {
+      if (!hb_buffer_set_length (buffer, entry->len))
+        return false;
+      hb_buffer_set_content_type (buffer, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+      info = hb_buffer_get_glyph_infos (buffer, NULL);
+      pos = hb_buffer_get_glyph_positions (buffer, NULL);
+      memcpy (info, entry->info, sizeof (hb_glyph_info_t) * entry->len);
+      memcpy (pos, entry->pos, sizeof (hb_glyph_position_t) * entry->len);
+      rq->word_cache.hits++;
+    }
+    else if (cacheable && _raqm_word_file_lookup (rq, &key, buffer))
+    {
+      _raqm_word_cache_insert (&rq->word_cache, &key, buffer);
+      rq->word_cache.hits++;
+    }
+    else if (cacheable)
+    {
+      rq->word_cache.misses++;
+      hb_buffer_add_utf32 (buffer, key.text, key.text_len, 0, key.text_len);
+      _raqm_hb_shape (rq, run->font, buffer, key.features, key.features_len);
+      _raqm_word_cache_insert (&rq->word_cache, &key, buffer);
+    }
+    else
+    {
+      hb_buffer_add_utf32 (buffer, rq->text, rq->text_len,
+                           word_start, word_end - word_start);
+      _raqm_hb_shape (rq, run->font, buffer, rq->features, rq->features_len);
+    }
 
-      FT_Get_Transform (hb_ft_font_get_ft_face (run->font), &matrix, NULL);
-      pos = hb_buffer_get_glyph_positions (run->buffer, &len);
-      info = hb_buffer_get_glyph_infos (run->buffer, &len);
+    if (!hb_buffer_allocation_successful (buffer))
+      return false;
 
+    /* Cached words have clusters relative to the word start */
+    if (cacheable)
+    {
+      info = hb_buffer_get_glyph_infos (buffer, &len);
       for (unsigned int i = 0; i < len; i++)
+        info[i].cluster += word_start;
+    }
+
+    if (!_raqm_append_glyphs (rq, run, buffer))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+_raqm_shape (raqm_t *rq)
+{
+  hb_buffer_flags_t hb_buffer_flags = _raqm_get_buffer_flags (rq);
+  hb_feature_t *features = NULL;
+  bool ok = true;
+
+  if (rq->word_cache.max_len && rq->features_len)
+  {
+    features = _raqm_arena_alloc (rq, sizeof (hb_feature_t) * rq->features_len);
+    if (!features)
+      return false;
+  }
+
+  if (!rq->shape_buffer)
+  {
+    rq->shape_buffer = hb_buffer_create ();
+    if (!hb_buffer_allocation_successful (rq->shape_buffer))
+      return false;
+  }
+
+  /* All the runs are shaped in the same buffer, and their glyphs appended to
+   * the glyph store one after the other. */
+  for (size_t r = 0; r < rq->runs_len; r++)
+  {
+    raqm_run_t *run = &rq->runs[r];
+
+    run->glyphs_start = rq->glyphs_len;
+    run->glyphs_len = 0;
+
+    if (rq->word_cache.max_len)
+    {
+      if (!_raqm_shape_words (rq, run, hb_buffer_flags, features))
+      {
+        ok = false;
+        break;
+      }
+    }
+    else
+    {
+      hb_buffer_clear_contents (rq->shape_buffer);
+      _raqm_setup_buffer (rq, rq->shape_buffer, run, hb_buffer_flags);
+      hb_buffer_add_utf32 (rq->shape_buffer, rq->text, rq->text_len,
+                           run->pos, run->len);
+      _raqm_hb_shape (rq, run->font, rq->shape_buffer, rq->features,
+                      rq->features_len);
+
+      if (!_raqm_append_glyphs (rq, run, rq->shape_buffer))
+      {
+        ok = false;
+        break;
+      }
+    }
+
+    {
+      FT_Matrix matrix;
+      raqm_glyph_t *glyphs = rq->glyphs + run->glyphs_start;
+      const uint32_t *clusters = rq->glyph_clusters + run->glyphs_start;
+      size_t len = run->glyphs_len;
+      size_t span;
+
+      span = _raqm_find_span (rq, run->pos, 0);
+      FT_Get_Transform (rq->spans[span].ftface, &matrix, NULL);
+
+      for (size_t i = 0; i < len; i++)
       {
-        _raqm_ft_transform (&pos[i].x_advance, &pos[i].y_advance, matrix);
-        _raqm_ft_transform (&pos[i].x_offset, &pos[i].y_offset, matrix);
+        _raqm_ft_transform (&glyphs[i].x_advance, &glyphs[i].y_advance, matrix);
+        _raqm_ft_transform (&glyphs[i].x_offset, &glyphs[i].y_offset, matrix);
+
+        bool set_spacing = false;
+        if (run->direction == HB_DIRECTION_RTL)
+        {
+          set_spacing = i == 0;
+          if (!set_spacing)
+            set_spacing = clusters[i] != clusters[i-1];
+        }
+        else
+        {
+          set_spacing = i == len - 1;
+          if (!set_spacing)
+            set_spacing = clusters[i] != clusters[i+1];
+        }
+
+        span = _raqm_find_span (rq, clusters[i], span);
+        int spacing_after = rq->spans[span].spacing_after;
+
+        if (spacing_after != 0 && set_spacing)
+        {
+          if (run->direction == HB_DIRECTION_TTB)
+            glyphs[i].y_advance -= spacing_after;
+          else if (run->direction == HB_DIRECTION_RTL)
+          {
+            glyphs[i].x_advance += spacing_after;
+            glyphs[i].x_offset += spacing_after;
+          }
+          else
+            glyphs[i].x_advance += spacing_after;
+        }
+      }
+    }
+  }
+
+  return ok;
+}
+
+static bool
+_raqm_layout_key_append (raqm_t     *rq,
+                         const void *data,
+                         size_t      len)
+{
+  if (rq->layout_key_len + len > rq->layout_key_capacity)
+  {
+    size_t capacity = rq->layout_key_capacity ? rq->layout_key_capacity : 256;
+    unsigned char *key;
+
+    while (capacity < rq->layout_key_len + len)
+      capacity *= 2;
+
+    key = _raqm_realloc (&rq->allocator, rq->layout_key, capacity);
+    if (!key)
+      return false;
+
+    rq->layout_key = key;
+    rq->layout_key_capacity = capacity;
+  }
+
+  memcpy (rq->layout_key + rq->layout_key_len, data, len);
+  rq->layout_key_len += len;
+
+  return true;
+}
+
+/* Serializes everything raqm_layout() output depends on into rq->layout_key.
+ * Returns false if the layout can’t be cached. */
+static bool
+_raqm_layout_cache_build_key (raqm_t *rq)
+{
+  /* Shaping word by word can give different output than whole runs */
+  bool word_cache = rq->word_cache.max_len != 0;
+
+  rq->layout_key_len = 0;
+
+  if (!_raqm_layout_key_append (rq, &rq->base_dir, sizeof (rq->base_dir)) ||
+      !_raqm_layout_key_append (rq, &word_cache, sizeof (word_cache)) ||
+      !_raqm_layout_key_append (rq, &rq->invisible_glyph,
+                                sizeof (rq->invisible_glyph)) ||
+      !_raqm_layout_key_append (rq, &rq->font_funcs,
+                                sizeof (rq->font_funcs)) ||
+      !_raqm_layout_key_append (rq, &rq->text_len, sizeof (rq->text_len)) ||
+      !_raqm_layout_key_append (rq, &rq->features_len,
+                                sizeof (rq->features_len)) ||
+      (rq->features_len &&
+       !_raqm_layout_key_append (rq, rq->features,
+                                 sizeof (hb_feature_t) * rq->features_len)) ||
+      !_raqm_layout_key_append (rq, rq->text,
+                                sizeof (uint32_t) * rq->text_len))
+    return false;
+
+  for (size_t i = 0; i < rq->spans_len; i++)
+  {
+    const _raqm_text_span *info = &rq->spans[i];
+    _raqm_layout_span span;
+
+    if (FT_HAS_MULTIPLE_MASTERS (info->ftface))
+      return false;
+
+    /* Zero the padding too, the key is compared as bytes */
+    memset (&span, 0, sizeof (span));
+    span.len = _raqm_span_end (rq, i) - info->start;
+    span.ftface = info->ftface;
+    span.lang = info->lang;
+    span.ftloadflags = info->ftloadflags;
+    span.spacing_after = info->spacing_after;
+    if (info->ftface->size)
+    {
+      span.x_scale = info->ftface->size->metrics.x_scale;
+      span.y_scale = info->ftface->size->metrics.y_scale;
+    }
+    FT_Get_Transform (info->ftface, &span.matrix, NULL);
+
+    if (!_raqm_layout_key_append (rq, &span, sizeof (span)))
+      return false;
+  }
+
+  return true;
+}
+
+/* Recreates the runs and their shaped buffers from a cached layout, as
+ * _raqm_itemize() and _raqm_shape() would have done. */
+static bool
+_raqm_layout_cache_restore (raqm_t                   *rq,
+                            const _raqm_layout_entry *entry)
+{
+  const raqm_glyph_t *cached_glyphs = entry->glyphs;
+  size_t span = 0;
+
+  rq->resolved_dir = entry->resolved_dir;
+
+  _raqm_reset_runs (rq);
+  for (size_t i = 0; i < entry->runs_len; i++)
+  {
+    const _raqm_layout_run *cached = &entry->runs[i];
+    raqm_run_t *run = _raqm_add_run (rq);
+    const _raqm_text_span *info;
+
+    if (!run)
+      return false;
+
+    run->pos = cached->pos;
+    run->len = cached->len;
+    run->direction = cached->direction;
+    run->script = cached->script;
+
+    span = _raqm_find_span (rq, cached->pos, span);
+    info = &rq->spans[span];
+    run->font = _raqm_get_hb_font (rq, info->ftface, info->ftloadflags);
+    if (!run->font)
+      return false;
+
+    if (!_raqm_reserve_glyphs (rq, rq->glyphs_len + cached->glyphs_len))
+      return false;
+
+    memcpy (rq->glyphs + rq->glyphs_len, cached_glyphs,
+            sizeof (raqm_glyph_t) * cached->glyphs_len);
+    for (size_t j = 0; j < cached->glyphs_len; j++)
+      rq->glyph_clusters[rq->glyphs_len + j] = cached_glyphs[j].cluster;
+
+    run->glyphs_len = cached->glyphs_len;
+    rq->glyphs_len += cached->glyphs_len;
+    cached_glyphs += cached->glyphs_len;
+  }
+
+  return true;
+}
+
+/* Stores the runs and glyphs of the finished layout under the key in
+ * rq->layout_key. */
+static void
+_raqm_layout_cache_insert (raqm_t  *rq,
+                           uint32_t hash)
+{
+  _raqm_layout_entry *entry;
+  size_t runs_len = rq->runs_len, glyphs_len = rq->glyphs_len;
+  size_t faces_len = 0;
+  size_t size;
+
+  /* Every span has a face, this is an upper bound of the distinct faces */
+  faces_len = rq->spans_len;
+
+  size = sizeof (_raqm_layout_entry) +
+         sizeof (FT_Face) * faces_len +
+         sizeof (raqm_glyph_t) * glyphs_len +
+         sizeof (_raqm_layout_run) * runs_len +
+         rq->layout_key_len;
+
+  entry = _raqm_malloc (&rq->allocator, size);
+  if (!entry)
+    return;
 
-        bool set_spacing = false;
-        if (run->direction == HB_DIRECTION_RTL)
-        {
-          set_spacing = i == 0;
-          if (!set_spacing)
-            set_spacing = info[i].cluster != info[i-1].cluster;
-        }
-        else
-        {
-          set_spacing = i == len - 1;
-          if (!set_spacing)
-            set_spacing = info[i].cluster != info[i+1].cluster;
-        }
+  entry->base.hash = hash;
+  entry->base.size = size;
+  entry->resolved_dir = rq->resolved_dir;
+  entry->faces = (FT_Face *) (entry + 1);
+  entry->glyphs = (raqm_glyph_t *) (entry->faces + faces_len);
+  entry->runs = (_raqm_layout_run *) (entry->glyphs + glyphs_len);
+  entry->key.data = (unsigned char *) (entry->runs + runs_len);
+  entry->key.len = rq->layout_key_len;
+  memcpy ((unsigned char *) entry->key.data, rq->layout_key,
+          rq->layout_key_len);
+
+  /* The key holds the face pointers, keep them alive so that they can’t be
+   * reused by different faces while the entry exists. */
+  entry->faces_len = 0;
+  for (size_t i = 0; i < rq->spans_len; i++)
+  {
+    FT_Face face = rq->spans[i].ftface;
+    size_t j;
 
-        _raqm_text_info rq_info = rq->text_info[info[i].cluster];
+    for (j = 0; j < entry->faces_len; j++)
+    {
+      if (entry->faces[j] == face)
+        break;
+    }
 
-        if (rq_info.spacing_after != 0 && set_spacing)
-        {
-          if (run->direction == HB_DIRECTION_TTB)
-            pos[i].y_advance -= rq_info.spacing_after;
-          else if (run->direction == HB_DIRECTION_RTL)
-          {
-            pos[i].x_advance += rq_info.spacing_after;
-            pos[i].x_offset += rq_info.spacing_after;
-          }
-          else
-            pos[i].x_advance += rq_info.spacing_after;
-        }
-      }
+    if (j == entry->faces_len)
+    {
+      FT_Reference_Face (face);
+      entry->faces[entry->faces_len++] = face;
     }
   }
 
-  return true;
+  /* The glyphs are stored before raqm_get_glyphs() converts their clusters,
+   * so they are always character indices. */
+  memcpy (entry->glyphs, rq->glyphs, sizeof (raqm_glyph_t) * glyphs_len);
+
+  entry->runs_len = 0;
+  for (size_t r = 0; r < rq->runs_len; r++)
+  {
+    const raqm_run_t *run = &rq->runs[r];
+    _raqm_layout_run *cached = &entry->runs[entry->runs_len++];
+
+    cached->pos = run->pos;
+    cached->len = run->len;
+    cached->direction = run->direction;
+    cached->script = run->script;
+    cached->glyphs_len = run->glyphs_len;
+  }
+
+  _raqm_cache_insert (&rq->layout_cache, &entry->base);
 }
 
-/* Count equivalent UTF-8 bytes in codepoint */
+/* The index of the last stored offset at or before @offset */
 static size_t
-_raqm_count_codepoint_utf8_bytes (uint32_t chr)
-{
-  if (0 == ((uint32_t) 0xffffff80 & chr))
-    return 1;
-  else if (0 == ((uint32_t) 0xfffff800 & chr))
-    return 2;
-  else if (0 == ((uint32_t) 0xffff0000 & chr))
-    return 3;
-  else
-    return 4;
+_raqm_find_text_offset (raqm_t *rq,
+                        size_t  offset)
+{
+  size_t lo = 0, hi = (rq->text_len - 1) / RAQM_TEXT_OFFSETS_STEP + 1;
+
+  while (hi - lo > 1)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (rq->text_offsets[mid] <= offset)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  return lo;
 }
 
 /* Convert index from UTF-32 to UTF-8 */
@@ -2404,12 +5788,18 @@ static uint32_t
 _raqm_u32_to_u8_index (raqm_t   *rq,
                        uint32_t  index)
 {
-  size_t length = 0;
+  const char *s, *end = rq->text_utf8 + rq->text_encoded_len;
+  uint32_t codepoint;
 
-  for (uint32_t i = 0; i < index; ++i)
-    length += _raqm_count_codepoint_utf8_bytes (rq->text[i]);
+  if (index >= rq->text_len)
+    return rq->text_encoded_len + (index - rq->text_len);
 
-  return length;
+  /* Decode forward from the nearest stored offset */
+  s = rq->text_utf8 + rq->text_offsets[index / RAQM_TEXT_OFFSETS_STEP];
+  for (size_t i = index - index % RAQM_TEXT_OFFSETS_STEP; i < index; i++)
+    s = _raqm_get_utf8_codepoint (s, end, &codepoint);
+
+  return s - rq->text_utf8;
 }
 
 /* Convert index from UTF-8 to UTF-32 */
@@ -2417,51 +5807,49 @@ static size_t
 _raqm_u8_to_u32_index (raqm_t   *rq,
                        size_t  index)
 {
-  const unsigned char *s = (const unsigned char *) rq->text_utf8;
-  const unsigned char *t = s;
-  size_t length = 0;
+  const char *s, *end = rq->text_utf8 + rq->text_encoded_len;
+  uint32_t codepoint;
+  size_t i, length;
 
-  while (((size_t) (s - t) < index) && ('\0' != *s))
+  if (index >= rq->text_encoded_len)
+    return rq->text_len + (index - rq->text_encoded_len);
+
+  i = _raqm_find_text_offset (rq, index);
+  s = rq->text_utf8 + rq->text_offsets[i];
+  length = i * RAQM_TEXT_OFFSETS_STEP;
+
+  /* Count the codepoints that start before the one containing @index */
+  for (;;)
   {
-    if (0xf0 == (0xf8 & *s))
-      s += 4;
-    else if (0xe0 == (0xf0 & *s))
-      s += 3;
-    else if (0xc0 == (0xe0 & *s))
-      s += 2;
-    else
-      s += 1;
+    const char *next = _raqm_get_utf8_codepoint (s, end, &codepoint);
+
+    if ((size_t) (next - rq->text_utf8) > index)
+      break;
 
+    s = next;
     length++;
   }
 
-  if ((size_t) (s-t) > index)
-    length--;
-
   return length;
 }
 
-/* Count equivalent UTF-16 short in codepoint */
-static size_t
-_raqm_count_codepoint_utf16_short (uint32_t chr)
-{
-  if (chr > 0x010000)
-    return 2;
-  else
-    return 1;
-}
-
 /* Convert index from UTF-32 to UTF-16 */
 static uint32_t
 _raqm_u32_to_u16_index (raqm_t   *rq,
                        uint32_t  index)
 {
-  size_t length = 0;
+  const uint16_t *s, *end = rq->text_utf16 + rq->text_encoded_len;
+  uint32_t codepoint;
 
-  for (uint32_t i = 0; i < index; ++i)
-    length += _raqm_count_codepoint_utf16_short (rq->text[i]);
+  if (index >= rq->text_len)
+    return rq->text_encoded_len + (index - rq->text_len);
 
-  return length;
+  /* Decode forward from the nearest stored offset */
+  s = rq->text_utf16 + rq->text_offsets[index / RAQM_TEXT_OFFSETS_STEP];
+  for (size_t i = index - index % RAQM_TEXT_OFFSETS_STEP; i < index; i++)
+    s = _raqm_get_utf16_codepoint (s, end, &codepoint);
+
+  return s - rq->text_utf16;
 }
 
 /* Convert index from UTF-16 to UTF-32 */
@@ -2469,23 +5857,29 @@ static size_t
 _raqm_u16_to_u32_index (raqm_t   *rq,
                        size_t  index)
 {
-  const uint16_t *s = (const uint16_t *) rq->text_utf16;
-  const uint16_t *t = s;
-  size_t length = 0;
+  const uint16_t *s, *end = rq->text_utf16 + rq->text_encoded_len;
+  uint32_t codepoint;
+  size_t i, length;
+
+  if (index >= rq->text_encoded_len)
+    return rq->text_len + (index - rq->text_encoded_len);
 
-  while (((size_t) (s - t) < index) && ('\0' != *s))
+  i = _raqm_find_text_offset (rq, index);
+  s = rq->text_utf16 + rq->text_offsets[i];
+  length = i * RAQM_TEXT_OFFSETS_STEP;
+
+  /* Count the codepoints that start before the one containing @index */
+  for (;;)
   {
-    if (*s < 0xD800 || *s > 0xDBFF)
-      s += 1;
-    else
-      s += 2;
+    const uint16_t *next = _raqm_get_utf16_codepoint (s, end, &codepoint);
 
+    if ((size_t) (next - rq->text_utf16) > index)
+      break;
+
+    s = next;
     length++;
   }
 
-  if ((size_t) (s-t) > index)
-    length--;
-
   return length;
 }
 
@@ -2500,6 +5894,17 @@ _raqm_encoding_to_u32_index (raqm_t *rq,
   return index;
 }
 
+static size_t
+_raqm_u32_to_encoding_index (raqm_t *rq,
+                             size_t  index)
+{
+  if (rq->text_utf8)
+    return _raqm_u32_to_u8_index (rq, index);
+  else if (rq->text_utf16)
+    return _raqm_u32_to_u16_index (rq, index);
+  return index;
+}
+
 /**
  * raqm_index_to_position:
  * @rq: a #raqm_t.
@@ -2544,31 +5949,29 @@ raqm_index_to_position (raqm_t *rq,
     ++*index;
   }
 
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
+  for (size_t r = 0; r < rq->runs_len; r++)
   {
-    size_t len;
-    hb_glyph_info_t *info;
-    hb_glyph_position_t *position;
-    len = hb_buffer_get_length (run->buffer);
-    info = hb_buffer_get_glyph_infos (run->buffer, NULL);
-    position = hb_buffer_get_glyph_positions (run->buffer, NULL);
+    const raqm_run_t *run = &rq->runs[r];
+    const raqm_glyph_t *glyphs = rq->glyphs + run->glyphs_start;
+    const uint32_t *clusters = rq->glyph_clusters + run->glyphs_start;
+    size_t len = run->glyphs_len;
 
     for (size_t i = 0; i < len; i++)
     {
-      uint32_t curr_cluster = info[i].cluster;
+      uint32_t curr_cluster = clusters[i];
       uint32_t next_cluster = curr_cluster;
-      *x += position[i].x_advance;
+      *x += glyphs[i].x_advance;
 
       if (run->direction == HB_DIRECTION_LTR)
       {
         for (size_t j = i + 1; j < len && next_cluster == curr_cluster; j++)
-          next_cluster = info[j].cluster;
+          next_cluster = clusters[j];
       }
       else
       {
         for (int j = i - 1; i != 0 && j >= 0 && next_cluster == curr_cluster;
              j--)
-          next_cluster = info[j].cluster;
+          next_cluster = clusters[j];
       }
 
       if (next_cluster == curr_cluster)
@@ -2577,7 +5980,7 @@ raqm_index_to_position (raqm_t *rq,
       if (*index < next_cluster && *index >= curr_cluster)
       {
         if (run->direction == HB_DIRECTION_RTL)
-          *x -= position[i].x_advance;
+          *x -= glyphs[i].x_advance;
         *index = curr_cluster;
         goto found;
       }
@@ -2632,18 +6035,16 @@ raqm_position_to_index (raqm_t *rq,
 
   RAQM_TEST ("\n");
 
-  for (raqm_run_t *run = rq->runs; run != NULL; run = run->next)
+  for (size_t r = 0; r < rq->runs_len; r++)
   {
-    size_t len;
-    hb_glyph_info_t *info;
-    hb_glyph_position_t *position;
-    len = hb_buffer_get_length (run->buffer);
-    info = hb_buffer_get_glyph_infos (run->buffer, NULL);
-    position = hb_buffer_get_glyph_positions (run->buffer, NULL);
+    const raqm_run_t *run = &rq->runs[r];
+    const raqm_glyph_t *glyphs = rq->glyphs + run->glyphs_start;
+    const uint32_t *clusters = rq->glyph_clusters + run->glyphs_start;
+    size_t len = run->glyphs_len;
 
     for (size_t i = 0; i < len; i++)
     {
-      delta_x = position[i].x_advance;
+      delta_x = glyphs[i].x_advance;
       if (x < (current_x + delta_x))
       {
         bool before = false;
@@ -2653,18 +6054,18 @@ raqm_position_to_index (raqm_t *rq,
           before = (x > current_x + (delta_x / 2));
 
         if (before)
-          *index = info[i].cluster;
+          *index = clusters[i];
         else
         {
-          uint32_t curr_cluster = info[i].cluster;
+          uint32_t curr_cluster = clusters[i];
           uint32_t next_cluster = curr_cluster;
           if (run->direction == HB_DIRECTION_LTR)
             for (size_t j = i + 1; j < len && next_cluster == curr_cluster; j++)
-              next_cluster = info[j].cluster;
+              next_cluster = clusters[j];
           else
           for (int j = i - 1; i != 0 && j >= 0 && next_cluster == curr_cluster;
                  j--)
-              next_cluster = info[j].cluster;
+              next_cluster = clusters[j];
 
           if (next_cluster == curr_cluster)
             next_cluster = run->pos + run->len;
@@ -2705,36 +6106,21 @@ raqm_position_to_index (raqm_t *rq,
   return true;
 }
 
-/**
- * raqm_allowed_grapheme_boundary:
- * @rq: a #raqm_t.
- * @index: the index of the boundary to check.
- *
- * Checks whether a grapheme cluster boundary is allowed between the characters
- * at @index and @index + 1, according to the Unicode Standard Annex #29 rules.
- *
- * The @rq must have had text set on it using raqm_set_text().
- *
- * Returns: `true` if a boundary is allowed, `false` otherwise.
- *
- * Since: 0.11
- **/
-RAQM_API bool
-raqm_allowed_grapheme_boundary (raqm_t *rq,
-                                size_t  index)
+/* Applies the Unicode Standard Annex #29 rules to the characters around a
+ * possible boundary, @l and @r. The rules that look further back use state
+ * carried along by _raqm_grapheme_pass():
+ * @after_ext_pict: the characters before @l end with ExtPict Extend*.
+ * @after_incb_linker: the characters up to @l end with
+ * InCB=Consonant [InCB=Extend InCB=Linker]* with at least one Linker.
+ * @ri_count: the number of regional indicators ending at @l. */
+static bool
+_raqm_is_grapheme_break (_raqm_grapheme_t l,
+                         _raqm_grapheme_t r,
+                         _raqm_incb_t     r_incb,
+                         bool             after_ext_pict,
+                         bool             after_incb_linker,
+                         size_t           ri_count)
 {
-  if (!rq)
-    return true;
-
-  /* GB1/GB2: break at start and end of text */
-  if (index >= rq->text_len - 1)
-    return true;
-
-  uint32_t l_char = rq->text[index];
-  uint32_t r_char = rq->text[index + 1];
-  _raqm_grapheme_t l = _raqm_get_grapheme_break (l_char);
-  _raqm_grapheme_t r = _raqm_get_grapheme_break (r_char);
-
   /* GB3: CR × LF */
   if (l == RAQM_GRAPHEME_CR && r == RAQM_GRAPHEME_LF)
     return false;
@@ -2778,69 +6164,375 @@ raqm_allowed_grapheme_boundary (raqm_t *rq,
     return false;
 
   /* GB9c: \p{InCB=Consonant} [\p{InCB=Extend}\p{InCB=Linker}]*
-   *        \p{InCB=Linker} [\p{InCB=Extend}\p{InCB=Linker}]* × \p{InCB=Consonant}
-   *
-   * If r_char is InCB=Consonant, look back for the required pattern. */
-  if (_raqm_get_incb (r_char) == RAQM_INCB_CONSONANT)
-  {
-    bool found_linker = false;
-    size_t j = index + 1;
-    while (j > 0)
-    {
-      j--;
-      _raqm_incb_t incb = _raqm_get_incb (rq->text[j]);
-      if (incb == RAQM_INCB_LINKER)
-        found_linker = true;
-      else if (incb == RAQM_INCB_EXTEND)
-        ; /* Continue looking back through Extend characters */
-      else if (incb == RAQM_INCB_CONSONANT)
-      {
-        if (found_linker)
-          return false;
-        break;
-      }
-      else
-        break;
-    }
-  }
+   *        \p{InCB=Linker} [\p{InCB=Extend}\p{InCB=Linker}]* × \p{InCB=Consonant} */
+  if (r_incb == RAQM_INCB_CONSONANT && after_incb_linker)
+    return false;
 
   /* GB11: ExtPict Extend* ZWJ × ExtPict */
   if (l == RAQM_GRAPHEME_ZWJ &&
-      r == RAQM_GRAPHEME_EXTENDED_PICTOGRAPHIC)
-  {
-    /* Look back past the ZWJ at index for Extend* ExtPict */
-    for (size_t j = index; j > 0; j--)
-    {
-      _raqm_grapheme_t g = _raqm_get_grapheme_break (rq->text[j - 1]);
-      if (g == RAQM_GRAPHEME_EXTEND)
-        continue;
-      if (g == RAQM_GRAPHEME_EXTENDED_PICTOGRAPHIC)
-        return false;
-      break;
-    }
-  }
+      r == RAQM_GRAPHEME_EXTENDED_PICTOGRAPHIC && after_ext_pict)
+    return false;
 
   /* GB12/GB13: Do not break between regional indicator symbols if there is
    * an odd number of RI characters before the break point. */
   if (l == RAQM_GRAPHEME_REGIONAL_INDICATOR &&
-      r == RAQM_GRAPHEME_REGIONAL_INDICATOR)
+      r == RAQM_GRAPHEME_REGIONAL_INDICATOR && ri_count % 2 == 1)
+    return false;
+
+  /* GB999: Otherwise, break everywhere. */
+  return true;
+}
+
+/* Goes through the boundaries between the characters of the text up to the
+ * one after @last, setting the bits of the allowed ones in @bits if not
+ * `NULL`. Returns whether the boundary after @last is allowed. */
+static bool
+_raqm_grapheme_pass (raqm_t   *rq,
+                     size_t    last,
+                     uint32_t *bits)
+{
+  uint8_t props = _raqm_get_props (rq->text[0]);
+  _raqm_grapheme_t l, r = RAQM_PROPS_GRAPHEME (props);
+  _raqm_incb_t l_incb, r_incb = RAQM_PROPS_INCB (props);
+  bool ext_pict = false, incb_consonant = false, incb_linker = false;
+  bool allowed = true;
+  size_t ri_count = 0;
+
+  for (size_t i = 0; i <= last; i++)
   {
-    size_t ri_count = 0;
-    for (size_t j = index + 1; j > 0; j--)
+    l = r;
+    l_incb = r_incb;
+    props = _raqm_get_props (rq->text[i + 1]);
+    r = RAQM_PROPS_GRAPHEME (props);
+    r_incb = RAQM_PROPS_INCB (props);
+
+    if (l_incb == RAQM_INCB_CONSONANT)
     {
-      if (_raqm_get_grapheme_break (rq->text[j - 1]) != RAQM_GRAPHEME_REGIONAL_INDICATOR)
-        break;
-      ri_count++;
+      incb_consonant = true;
+      incb_linker = false;
     }
-    /* If odd number of RI before the break, don't break (they pair up) */
-    if (ri_count % 2 == 1)
+    else if (l_incb == RAQM_INCB_LINKER)
+      incb_linker = incb_consonant;
+    else if (l_incb != RAQM_INCB_EXTEND)
+      incb_consonant = incb_linker = false;
+
+    ri_count = l == RAQM_GRAPHEME_REGIONAL_INDICATOR ? ri_count + 1 : 0;
+
+    allowed = _raqm_is_grapheme_break (l, r, r_incb, ext_pict, incb_linker,
+                                       ri_count);
+    if (allowed && bits)
+      bits[i / 32] |= (uint32_t) 1 << (i % 32);
+
+    ext_pict = l == RAQM_GRAPHEME_EXTENDED_PICTOGRAPHIC ||
+               (ext_pict && l == RAQM_GRAPHEME_EXTEND);
+  }
+
+  return allowed;
+}
+
+/* Computes all the grapheme boundaries of the text in one pass, the first
+ * time they are needed after the text is set. */
+static bool
+_raqm_compute_grapheme_breaks (raqm_t *rq)
+{
+  size_t words = (rq->text_len + 31) / 32;
+
+  if (rq->grapheme_breaks_valid)
+    return true;
+
+  if (words > rq->grapheme_breaks_capacity)
+  {
+    uint32_t *bits = _raqm_realloc (&rq->allocator, rq->grapheme_breaks,
+                                    sizeof (uint32_t) * words);
+    if (!bits)
       return false;
+
+    rq->grapheme_breaks = bits;
+    rq->grapheme_breaks_capacity = words;
   }
 
-  /* GB999: Otherwise, break everywhere. */
+  memset (rq->grapheme_breaks, 0, sizeof (uint32_t) * words);
+  _raqm_grapheme_pass (rq, rq->text_len - 2, rq->grapheme_breaks);
+  rq->grapheme_breaks_valid = true;
+
   return true;
 }
 
+/**
+ * raqm_allowed_grapheme_boundary:
+ * @rq: a #raqm_t.
+ * @index: the index of the boundary to check.
+ *
+ * Checks whether a grapheme cluster boundary is allowed between the characters
+ * at @index and @index + 1, according to the Unicode Standard Annex #29 rules.
+ *
+ * The @rq must have had text set on it using raqm_set_text().
+ *
+ * Returns: `true` if a boundary is allowed, `false` otherwise.
+ *
+ * Since: 0.11
+ **/
+RAQM_API bool
+raqm_allowed_grapheme_boundary (raqm_t *rq,
+                                size_t  index)
+{
+  if (!rq)
+    return true;
+
+  /* GB1/GB2: break at start and end of text */
+  if (index + 1 >= rq->text_len)
+    return true;
+
+  if (!_raqm_compute_grapheme_breaks (rq))
+    return _raqm_grapheme_pass (rq, index, NULL);
+
+  return rq->grapheme_breaks[index / 32] & ((uint32_t) 1 << (index % 32));
+}
+
+/* Returns the offset in the original string of the codepoint after the one
+ * at @offset. */
+static size_t
+_raqm_next_encoding_offset (raqm_t *rq,
+                            size_t  offset)
+{
+  uint32_t codepoint;
+
+  if (rq->text_utf8)
+    return _raqm_get_utf8_codepoint (rq->text_utf8 + offset,
+                                     rq->text_utf8 + rq->text_encoded_len,
+                                     &codepoint) - rq->text_utf8;
+  else if (rq->text_utf16)
+    return _raqm_get_utf16_codepoint (rq->text_utf16 + offset,
+                                      rq->text_utf16 + rq->text_encoded_len,
+                                      &codepoint) - rq->text_utf16;
+  return offset + 1;
+}
+
+/**
+ * raqm_get_grapheme_boundaries:
+ * @rq: a #raqm_t.
+ * @offsets: (out) (array length=max_offsets) (nullable): array to fill with
+ * the boundaries.
+ * @max_offsets: the number of elements @offsets can hold.
+ *
+ * Gets all the grapheme cluster boundaries of the text of @rq in one call,
+ * according to the Unicode Standard Annex #29 rules. This is the same as
+ * calling raqm_allowed_grapheme_boundary() for every character, but the
+ * boundaries are given as input string array indices, counting elements
+ * according to the underlying encoding (i.e. bytes in UTF-8).
+ *
+ * The boundaries are stored in increasing order, starting with 0 for the
+ * start of the text and ending with its length, so that each pair of
+ * consecutive offsets delimits a grapheme cluster. At most @max_offsets of
+ * them are stored.
+ *
+ * Return value:
+ * The total number of boundaries, which may be larger than @max_offsets.
+ * Pass `NULL` to only get the number.
+ *
+ * Since: 0.12
+ **/
+size_t
+raqm_get_grapheme_boundaries (raqm_t *rq,
+                              size_t *offsets,
+                              size_t  max_offsets)
+{
+  size_t count = 0, offset = 0;
+
+  if (!rq || !rq->text_len)
+    return 0;
+
+  if (!offsets)
+    max_offsets = 0;
+
+  if (max_offsets)
+    offsets[0] = 0;
+  count++;
+
+  for (size_t i = 0; i < rq->text_len; i++)
+  {
+    offset = _raqm_next_encoding_offset (rq, offset);
+
+    if (raqm_allowed_grapheme_boundary (rq, i))
+    {
+      if (count < max_offsets)
+        offsets[count] = offset;
+      count++;
+    }
+  }
+
+  return count;
+}
+
+/**
+ * raqm_get_cluster_map:
+ * @rq: a #raqm_t.
+ * @cluster_map: (out) (array length=length) (nullable): array to fill with
+ * the glyph indices.
+ * @length: the number of elements @cluster_map can hold.
+ *
+ * Maps each element of the input text, counting according to the underlying
+ * encoding (i.e. bytes in UTF-8), to the first glyph of the cluster it belongs
+ * to, as an index into the array returned by raqm_get_glyphs(). The first
+ * glyph is the one that comes first in that array, which for right-to-left
+ * text is the visually leftmost one. All the elements of a cluster map to the
+ * same glyph. Characters that gave no glyph at all, e.g. default ignorables
+ * removed with raqm_set_invisible_glyph(), map to the glyph following them in
+ * the array, which is the number of glyphs if they come last. At most
+ * @length of them are stored.
+ *
+ * Return value:
+ * The length of the text, which may be larger than @length, or 0 if
+ * raqm_layout() has not been called on @rq. Pass `NULL` and 0 to only get
+ * the length.
+ *
+ * Since: 0.12
+ */
+size_t
+raqm_get_cluster_map (raqm_t *rq,
+                      size_t *cluster_map,
+                      size_t  length)
+{
+  if (!rq || !rq->runs_len)
+    return 0;
+
+  if (!cluster_map)
+    length = 0;
+
+  for (size_t i = 0; i < rq->runs_len && length; i++)
+  {
+    const raqm_run_t *run = &rq->runs[i];
+    const uint32_t *clusters = rq->glyph_clusters + run->glyphs_start;
+    bool backward = HB_DIRECTION_IS_BACKWARD (run->direction);
+    size_t j = 0;
+
+    if (!run->glyphs_len)
+    {
+      size_t start = _raqm_u32_to_encoding_index (rq, run->pos);
+      size_t end = _raqm_u32_to_encoding_index (rq, run->pos + run->len);
+
+      for (size_t u = start; u < end && u < length; u++)
+        cluster_map[u] = run->glyphs_start;
+      continue;
+    }
+
+    /* Clusters are monotonic within a run, so the characters of each cluster
+     * extend up to the start of the next one in logical order, which follows
+     * it in the glyph order, or precedes it in backward runs. */
+    while (j < run->glyphs_len)
+    {
+      size_t k = j + 1, start, end;
+
+      while (k < run->glyphs_len && clusters[k] == clusters[j])
+        k++;
+
+      start = clusters[j];
+      if (backward)
+      {
+        end = j ? clusters[j - 1] : run->pos + run->len;
+        if (k == run->glyphs_len)
+          start = run->pos;
+      }
+      else
+      {
+        end = k < run->glyphs_len ? clusters[k] : run->pos + run->len;
+        if (!j)
+          start = run->pos;
+      }
+
+      start = _raqm_u32_to_encoding_index (rq, start);
+      end = _raqm_u32_to_encoding_index (rq, end);
+      for (size_t u = start; u < end && u < length; u++)
+        cluster_map[u] = run->glyphs_start + j;
+
+      j = k;
+    }
+  }
+
+  return _raqm_u32_to_encoding_index (rq, rq->text_len);
+}
+
+/**
+ * raqm_get_visual_order:
+ * @rq: a #raqm_t.
+ * @logical_to_visual: (out) (array length=length) (nullable): array to fill
+ * with the visual position of each logical position.
+ * @visual_to_logical: (out) (array length=length) (nullable): array to fill
+ * with the logical position of each visual position.
+ * @length: the number of elements each array can hold.
+ *
+ * Gets the reordering of the input text done by the bidirectional algorithm,
+ * counting according to the underlying encoding (i.e. bytes in UTF-8). The
+ * visual order follows the runs as laid out, reversing the characters of
+ * right-to-left runs. Characters encoded in several elements keep them in
+ * logical order, so that each is still contiguous. The two arrays are the
+ * inverse of each other, and at most @length elements of each are stored.
+ *
+ * Return value:
+ * The length of the text, which may be larger than @length, or 0 if
+ * raqm_layout() has not been called on @rq. Pass `NULL` and 0 to only get
+ * the length.
+ *
+ * Since: 0.12
+ */
+size_t
+raqm_get_visual_order (raqm_t *rq,
+                       size_t *logical_to_visual,
+                       size_t *visual_to_logical,
+                       size_t  length)
+{
+  size_t visual = 0;
+
+  if (!rq || !rq->runs_len)
+    return 0;
+
+  for (size_t i = 0; i < rq->runs_len; i++)
+  {
+    const raqm_run_t *run = &rq->runs[i];
+    size_t start = _raqm_u32_to_encoding_index (rq, run->pos);
+    size_t end = _raqm_u32_to_encoding_index (rq, run->pos + run->len);
+
+    if (!HB_DIRECTION_IS_BACKWARD (run->direction))
+    {
+      for (size_t u = start; u < end; u++)
+      {
+        size_t v = visual + u - start;
+
+        if (u < length && logical_to_visual)
+          logical_to_visual[u] = v;
+        if (v < length && visual_to_logical)
+          visual_to_logical[v] = u;
+      }
+    }
+    else
+    {
+      /* The last character comes first, each keeping its elements in
+       * order. */
+      size_t u = start;
+
+      while (u < end)
+      {
+        size_t next = _raqm_next_encoding_offset (rq, u);
+
+        for (size_t k = u; k < next; k++)
+        {
+          size_t v = visual + (end - next) + (k - u);
+
+          if (k < length && logical_to_visual)
+            logical_to_visual[k] = v;
+          if (v < length && visual_to_logical)
+            visual_to_logical[v] = k;
+        }
+        u = next;
+      }
+    }
+
+    visual += end - start;
+  }
+
+  return _raqm_u32_to_encoding_index (rq, rq->text_len);
+}
+
 /**
  * raqm_version:
  * @major: (out): Library major version component.
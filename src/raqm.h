@@ -74,6 +74,70 @@ typedef enum
     RAQM_DIRECTION_TTB
 } raqm_direction_t;
 
+/**
+ * raqm_font_funcs_t:
+ * @RAQM_FONT_FUNCS_FREETYPE: Load glyph metrics with FreeType.
+ * @RAQM_FONT_FUNCS_OPENTYPE: Read glyph metrics from the OpenType tables
+ * with HarfBuzz.
+ *
+ * Where glyph metrics are taken from during shaping, see
+ * raqm_set_font_funcs().
+ *
+ * Since: 0.12
+ */
+typedef enum
+{
+    RAQM_FONT_FUNCS_FREETYPE,
+    RAQM_FONT_FUNCS_OPENTYPE
+} raqm_font_funcs_t;
+
+/**
+ * raqm_malloc_func_t:
+ * @size: the number of bytes to allocate.
+ * @user_data: the data passed to raqm_create_with_allocator().
+ *
+ * A function allocating memory like malloc(), see
+ * raqm_create_with_allocator().
+ *
+ * Return value:
+ * The allocated memory, or `NULL` in case of error.
+ *
+ * Since: 0.12
+ */
+typedef void *(*raqm_malloc_func_t) (size_t size,
+                                     void  *user_data);
+
+/**
+ * raqm_realloc_func_t:
+ * @ptr: the memory to resize, or `NULL`.
+ * @size: the new size in bytes.
+ * @user_data: the data passed to raqm_create_with_allocator().
+ *
+ * A function resizing memory like realloc(), see
+ * raqm_create_with_allocator().
+ *
+ * Return value:
+ * The resized memory, or `NULL` in case of error, in which case @ptr is left
+ * untouched.
+ *
+ * Since: 0.12
+ */
+typedef void *(*raqm_realloc_func_t) (void  *ptr,
+                                      size_t size,
+                                      void  *user_data);
+
+/**
+ * raqm_free_func_t:
+ * @ptr: the memory to release.
+ * @user_data: the data passed to raqm_create_with_allocator().
+ *
+ * A function releasing memory like free(), see raqm_create_with_allocator().
+ *
+ * Since: 0.12
+ */
+typedef void (*raqm_free_func_t) (void *ptr,
+                                  void *user_data);
+
 /**
  * raqm_glyph_t:
  * @index: the index of the glyph in the font file.
@@ -97,9 +161,61 @@ typedef struct raqm_glyph_t {
     FT_Face ftface;
 } raqm_glyph_t;
 
+/**
+ * raqm_glyph_func_t:
+ * @glyph: the glyph.
+ * @user_data: the data passed to raqm_layout_foreach_glyph().
+ *
+ * A function called for each output glyph by raqm_layout_foreach_glyph().
+ *
+ * Return value:
+ * `true` to go on with the next glyph, `false` to stop.
+ *
+ * Since: 0.12
+ */
+typedef bool (*raqm_glyph_func_t) (const raqm_glyph_t *glyph,
+                                   void               *user_data);
+
+/**
+ * raqm_run_info_t:
+ * @start: the index of the first character of the run in the input text.
+ * @length: the length of the run in the input text.
+ * @direction: the direction of the run.
+ * @script: the ISO 15924 tag of the script of the run, e.g. `Arab`, packed
+ * like an OpenType tag.
+ * @language: the BCP47 language code of the run, see raqm_set_language(), or
+ * `NULL` if it is not known.
+ * @ftface: the @FT_Face of the glyphs of the run.
+ * @glyphs_start: the index of the first glyph of the run in the output
+ * glyphs.
+ * @glyphs_len: the number of glyphs of the run.
+ *
+ * The structure that holds information about output runs, returned from
+ * raqm_get_runs(). Input text indices count elements according to the
+ * encoding the text was set with.
+ *
+ * Since: 0.12
+ */
+typedef struct raqm_run_info_t {
+    size_t start;
+    size_t length;
+    raqm_direction_t direction;
+    uint32_t script;
+    const char *language;
+    FT_Face ftface;
+    size_t glyphs_start;
+    size_t glyphs_len;
+} raqm_run_info_t;
+
 RAQM_API raqm_t *
 raqm_create (void);
 
+RAQM_API raqm_t *
+raqm_create_with_allocator (raqm_malloc_func_t  malloc_func,
+                            raqm_realloc_func_t realloc_func,
+                            raqm_free_func_t    free_func,
+                            void               *user_data);
+
 RAQM_API raqm_t *
 raqm_reference (raqm_t *rq);
 
@@ -123,6 +239,21 @@ raqm_set_text_utf16 (raqm_t     *rq,
                     const uint16_t *text,
                     size_t      len);
 
+RAQM_API bool
+raqm_set_text_borrowed (raqm_t         *rq,
+                        const uint32_t *text,
+                        size_t          len);
+
+RAQM_API bool
+raqm_set_text_utf8_borrowed (raqm_t     *rq,
+                             const char *text,
+                             size_t      len);
+
+RAQM_API bool
+raqm_set_text_utf16_borrowed (raqm_t         *rq,
+                              const uint16_t *text,
+                              size_t          len);
+
 RAQM_API bool
 raqm_set_par_direction (raqm_t          *rq,
                         raqm_direction_t dir);
@@ -173,6 +304,41 @@ RAQM_API bool
 raqm_set_invisible_glyph (raqm_t *rq,
                           int gid);
 
+RAQM_API bool
+raqm_set_font_funcs (raqm_t           *rq,
+                     raqm_font_funcs_t funcs);
+
+RAQM_API bool
+raqm_set_font_cache_size (raqm_t *rq,
+                          size_t  size);
+
+RAQM_API bool
+raqm_set_word_cache_size (raqm_t *rq,
+                          size_t  size);
+
+RAQM_API void
+raqm_get_word_cache_stats (raqm_t *rq,
+                           size_t *hits,
+                           size_t *misses);
+
+RAQM_API bool
+raqm_save_word_cache (raqm_t     *rq,
+                      const char *filename);
+
+RAQM_API bool
+raqm_load_word_cache (raqm_t     *rq,
+                      const char *filename);
+
+RAQM_API bool
+raqm_set_layout_cache_size (raqm_t *rq,
+                            size_t  max_entries,
+                            size_t  max_bytes);
+
+RAQM_API void
+raqm_get_layout_cache_stats (raqm_t *rq,
+                             size_t *hits,
+                             size_t *misses);
+
 RAQM_API bool
 raqm_layout (raqm_t *rq);
 
@@ -180,6 +346,37 @@ RAQM_API raqm_glyph_t *
 raqm_get_glyphs (raqm_t *rq,
                  size_t *length);
 
+RAQM_API bool
+raqm_layout_foreach_glyph (raqm_t           *rq,
+                           raqm_glyph_func_t func,
+                           void             *user_data);
+
+RAQM_API size_t
+raqm_get_glyph_arrays (raqm_t       *rq,
+                       size_t        start,
+                       size_t        length,
+                       unsigned int *indices,
+                       int          *x_advances,
+                       int          *y_advances,
+                       int          *x_offsets,
+                       int          *y_offsets,
+                       uint32_t     *clusters);
+
+RAQM_API size_t
+raqm_get_glyph_positions (raqm_t  *rq,
+                          size_t   start,
+                          size_t   length,
+                          int64_t *x,
+                          int64_t *y,
+                          int     *x_positions,
+                          int     *y_positions,
+                          int      grid);
+
+RAQM_API size_t
+raqm_get_runs (raqm_t          *rq,
+               raqm_run_info_t *runs,
+               size_t           max_runs);
+
 RAQM_API raqm_direction_t
 raqm_get_par_resolved_direction (raqm_t *rq);
 
@@ -214,6 +411,22 @@ RAQM_API bool
 raqm_allowed_grapheme_boundary (raqm_t *rq,
                                 size_t  index);
 
+RAQM_API size_t
+raqm_get_grapheme_boundaries (raqm_t *rq,
+                              size_t *offsets,
+                              size_t  max_offsets);
+
+RAQM_API size_t
+raqm_get_cluster_map (raqm_t *rq,
+                      size_t *cluster_map,
+                      size_t  length);
+
+RAQM_API size_t
+raqm_get_visual_order (raqm_t *rq,
+                       size_t *logical_to_visual,
+                       size_t *visual_to_logical,
+                       size_t  length);
+
 RAQM_API bool
 raqm_version_atleast (unsigned int major,
                       unsigned int minor,
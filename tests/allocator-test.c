@@ -0,0 +1,162 @@
+/*
+ * Custom allocator test.
+ *
+ * Verifies that a raqm_t created with raqm_create_with_allocator() gives the
+ * same output as one using the C library allocator, that its memory goes
+ * through the given functions, and that all of it is released by
+ * raqm_destroy(), with the caches in use too.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+typedef struct
+{
+  size_t allocations;
+  size_t live;
+} counts_t;
+
+/* Every block is prefixed with its owner, so that frees can be checked */
+typedef union
+{
+  counts_t   *counts;
+  long double align;
+} header_t;
+
+static void *
+counting_malloc (size_t size,
+                 void  *user_data)
+{
+  header_t *header = malloc (sizeof (header_t) + size);
+
+  if (!header)
+    return NULL;
+
+  header->counts = user_data;
+  header->counts->allocations++;
+  header->counts->live++;
+
+  return header + 1;
+}
+
+static void *
+counting_realloc (void  *ptr,
+                  size_t size,
+                  void  *user_data)
+{
+  header_t *header;
+
+  if (!ptr)
+    return counting_malloc (size, user_data);
+
+  header = (header_t *) ptr - 1;
+  assert (header->counts == user_data);
+
+  header = realloc (header, sizeof (header_t) + size);
+  if (!header)
+    return NULL;
+
+  header->counts->allocations++;
+
+  return header + 1;
+}
+
+static void
+counting_free (void *ptr,
+               void *user_data)
+{
+  header_t *header;
+
+  assert (ptr);
+
+  header = (header_t *) ptr - 1;
+  assert (header->counts == user_data);
+  assert (header->counts->live > 0);
+  header->counts->live--;
+
+  free (header);
+}
+
+static raqm_glyph_t *
+layout (raqm_t     *rq,
+        FT_Face     face,
+        const char *text,
+        size_t     *count)
+{
+  raqm_glyph_t *glyphs, *copy;
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_add_font_feature (rq, "-liga", -1));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, count);
+  assert (glyphs != NULL);
+
+  copy = malloc (sizeof (raqm_glyph_t) * *count);
+  assert (copy);
+  memcpy (copy, glyphs, sizeof (raqm_glyph_t) * *count);
+
+  raqm_clear_contents (rq);
+
+  return copy;
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *text = "Hello عربي world";
+  counts_t counts = { 0, 0 };
+  FT_Library library;
+  FT_Face face;
+  raqm_t *rq;
+  raqm_glyph_t *expected, *glyphs;
+  size_t expected_count, count;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  assert (!raqm_create_with_allocator (NULL, counting_realloc, counting_free,
+                                       &counts));
+  assert (counts.allocations == 0);
+
+  rq = raqm_create ();
+  assert (rq);
+  expected = layout (rq, face, text, &expected_count);
+  raqm_destroy (rq);
+
+  rq = raqm_create_with_allocator (counting_malloc, counting_realloc,
+                                   counting_free, &counts);
+  assert (rq);
+  assert (counts.live == 1);
+
+  assert (raqm_set_word_cache_size (rq, 16));
+  assert (raqm_set_layout_cache_size (rq, 4, 0));
+
+  for (int i = 0; i < 3; i++)
+  {
+    glyphs = layout (rq, face, text, &count);
+    assert (count == expected_count);
+    assert (memcmp (glyphs, expected, sizeof (raqm_glyph_t) * count) == 0);
+    free (glyphs);
+  }
+
+  assert (counts.allocations > 1);
+  assert (counts.live > 1);
+
+  raqm_destroy (rq);
+  assert (counts.live == 0);
+
+  free (expected);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
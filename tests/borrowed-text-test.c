@@ -0,0 +1,209 @@
+/*
+ * Borrowed text test.
+ *
+ * Verifies that text set with the raqm_set_text_*_borrowed() functions gives
+ * the same glyphs, clusters and cursor positions as copied text in every
+ * encoding, and that the borrowed buffer is no longer needed after
+ * raqm_clear_contents().
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+typedef enum
+{
+  ENCODING_UTF8,
+  ENCODING_UTF16,
+  ENCODING_UTF32
+} encoding_t;
+
+static const uint32_t text_utf32[] = {
+  'H', 'e', 'l', 'l', 'o', ' ', 0x0639, 0x0631, 0x0628, 0x064A, ' ',
+  0x1F600, ' ', 'x', 0x0301
+};
+#define TEXT_LEN (sizeof (text_utf32) / sizeof (text_utf32[0]))
+
+static size_t
+encode_utf8 (char *out)
+{
+  size_t len = 0;
+
+  for (size_t i = 0; i < TEXT_LEN; i++)
+  {
+    uint32_t c = text_utf32[i];
+
+    if (c < 0x80)
+      out[len++] = c;
+    else if (c < 0x800)
+    {
+      out[len++] = 0xC0 | (c >> 6);
+      out[len++] = 0x80 | (c & 0x3F);
+    }
+    else if (c < 0x10000)
+    {
+      out[len++] = 0xE0 | (c >> 12);
+      out[len++] = 0x80 | ((c >> 6) & 0x3F);
+      out[len++] = 0x80 | (c & 0x3F);
+    }
+    else
+    {
+      out[len++] = 0xF0 | (c >> 18);
+      out[len++] = 0x80 | ((c >> 12) & 0x3F);
+      out[len++] = 0x80 | ((c >> 6) & 0x3F);
+      out[len++] = 0x80 | (c & 0x3F);
+    }
+  }
+
+  return len;
+}
+
+static size_t
+encode_utf16 (uint16_t *out)
+{
+  size_t len = 0;
+
+  for (size_t i = 0; i < TEXT_LEN; i++)
+  {
+    uint32_t c = text_utf32[i];
+
+    if (c < 0x10000)
+      out[len++] = c;
+    else
+    {
+      out[len++] = 0xD800 + ((c - 0x10000) >> 10);
+      out[len++] = 0xDC00 + ((c - 0x10000) & 0x3FF);
+    }
+  }
+
+  return len;
+}
+
+static void
+set_text (raqm_t     *rq,
+          encoding_t  encoding,
+          const void *text,
+          size_t      len,
+          int         borrowed)
+{
+  switch (encoding)
+  {
+    case ENCODING_UTF8:
+      assert (borrowed ? raqm_set_text_utf8_borrowed (rq, text, len) :
+                         raqm_set_text_utf8 (rq, text, len));
+      break;
+    case ENCODING_UTF16:
+      assert (borrowed ? raqm_set_text_utf16_borrowed (rq, text, len) :
+                         raqm_set_text_utf16 (rq, text, len));
+      break;
+    case ENCODING_UTF32:
+      assert (borrowed ? raqm_set_text_borrowed (rq, text, len) :
+                         raqm_set_text (rq, text, len));
+      break;
+  }
+}
+
+static void
+test_encoding (FT_Face     face,
+               encoding_t  encoding,
+               const void *text,
+               size_t      len,
+               size_t      unit_size)
+{
+  raqm_t *copied, *borrowed;
+  raqm_glyph_t *glyphs, *borrowed_glyphs;
+  size_t count, borrowed_count;
+  void *buffer;
+
+  /* Lay out a copy of the text from a buffer that is freed as soon as it is
+   * no longer needed, so that any use after that is caught. */
+  buffer = malloc (len * unit_size);
+  assert (buffer);
+  memcpy (buffer, text, len * unit_size);
+
+  copied = raqm_create ();
+  borrowed = raqm_create ();
+  assert (copied && borrowed);
+
+  set_text (copied, encoding, text, len, 0);
+  set_text (borrowed, encoding, buffer, len, 1);
+  assert (raqm_set_freetype_face (copied, face));
+  assert (raqm_set_freetype_face (borrowed, face));
+  assert (raqm_layout (copied));
+  assert (raqm_layout (borrowed));
+
+  glyphs = raqm_get_glyphs (copied, &count);
+  borrowed_glyphs = raqm_get_glyphs (borrowed, &borrowed_count);
+  assert (glyphs && borrowed_glyphs);
+  assert (count == borrowed_count);
+  assert (memcmp (glyphs, borrowed_glyphs, sizeof (raqm_glyph_t) * count) == 0);
+
+  for (size_t i = 0; i <= len; i++)
+  {
+    size_t index = i, borrowed_index = i;
+    int x, y, borrowed_x, borrowed_y;
+    bool ok = raqm_index_to_position (copied, &index, &x, &y);
+
+    assert (ok == raqm_index_to_position (borrowed, &borrowed_index,
+                                          &borrowed_x, &borrowed_y));
+    if (ok)
+    {
+      assert (index == borrowed_index);
+      assert (x == borrowed_x && y == borrowed_y);
+    }
+  }
+
+  {
+    size_t offsets[64], borrowed_offsets[64];
+    size_t n = raqm_get_grapheme_boundaries (copied, offsets, 64);
+
+    assert (n <= 64);
+    assert (n == raqm_get_grapheme_boundaries (borrowed, borrowed_offsets, 64));
+    assert (memcmp (offsets, borrowed_offsets, sizeof (size_t) * n) == 0);
+  }
+
+  /* After clearing, the borrowed buffer can go and the object be reused. */
+  raqm_clear_contents (borrowed);
+  memset (buffer, 0, len * unit_size);
+  free (buffer);
+
+  set_text (borrowed, encoding, text, len, 1);
+  assert (raqm_set_freetype_face (borrowed, face));
+  assert (raqm_layout (borrowed));
+  borrowed_glyphs = raqm_get_glyphs (borrowed, &borrowed_count);
+  assert (count == borrowed_count);
+  assert (memcmp (glyphs, borrowed_glyphs, sizeof (raqm_glyph_t) * count) == 0);
+
+  raqm_destroy (copied);
+  raqm_destroy (borrowed);
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face;
+  char utf8[TEXT_LEN * 4];
+  uint16_t utf16[TEXT_LEN * 2];
+  size_t utf8_len, utf16_len;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  utf8_len = encode_utf8 (utf8);
+  utf16_len = encode_utf16 (utf16);
+
+  test_encoding (face, ENCODING_UTF8, utf8, utf8_len, sizeof (char));
+  test_encoding (face, ENCODING_UTF16, utf16, utf16_len, sizeof (uint16_t));
+  test_encoding (face, ENCODING_UTF32, text_utf32, TEXT_LEN, sizeof (uint32_t));
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
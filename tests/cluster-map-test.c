@@ -0,0 +1,220 @@
+/*
+ * Cluster map and visual order test.
+ *
+ * Verifies raqm_get_cluster_map() against a scan of the output glyphs, and
+ * that raqm_get_visual_order() gives inverse permutations that reverse the
+ * characters of right-to-left runs and keep the rest in order.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+#define MAX_RUNS 16
+
+static void
+check_cluster_map (raqm_t *rq,
+                   size_t  text_len)
+{
+  raqm_glyph_t *glyphs;
+  raqm_run_info_t runs[MAX_RUNS];
+  size_t count, n, *map;
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs);
+  n = raqm_get_runs (rq, runs, MAX_RUNS);
+  assert (n <= MAX_RUNS);
+
+  assert (raqm_get_cluster_map (rq, NULL, 0) == text_len);
+  map = malloc (sizeof (size_t) * text_len);
+  assert (map);
+  assert (raqm_get_cluster_map (rq, map, text_len) == text_len);
+
+  for (size_t r = 0; r < n; r++)
+  {
+    const raqm_run_info_t *run = &runs[r];
+
+    size_t run_end = run->glyphs_start + run->glyphs_len;
+
+    for (size_t u = run->start; u < run->start + run->length; u++)
+    {
+      size_t first = SIZE_MAX;
+      uint32_t cluster = run->start;
+
+      /* The cluster is the last one starting at or before u */
+      for (size_t g = run->glyphs_start; g < run_end; g++)
+        if (glyphs[g].cluster <= u && glyphs[g].cluster > cluster)
+          cluster = glyphs[g].cluster;
+
+      for (size_t g = run->glyphs_start; g < run_end && first == SIZE_MAX; g++)
+        if (glyphs[g].cluster == cluster)
+          first = g;
+
+      assert (first != SIZE_MAX);
+      assert (map[u] == first);
+    }
+  }
+
+  /* Partial output */
+  if (text_len > 2)
+  {
+    size_t partial[2];
+    assert (raqm_get_cluster_map (rq, partial, 2) == text_len);
+    assert (partial[0] == map[0] && partial[1] == map[1]);
+  }
+
+  free (map);
+}
+
+static void
+check_visual_order (raqm_t     *rq,
+                    const char *text,
+                    size_t      text_len)
+{
+  raqm_run_info_t runs[MAX_RUNS];
+  size_t n, *l2v, *v2l, visual = 0;
+
+  n = raqm_get_runs (rq, runs, MAX_RUNS);
+  assert (n <= MAX_RUNS);
+
+  l2v = malloc (sizeof (size_t) * text_len);
+  v2l = malloc (sizeof (size_t) * text_len);
+  assert (l2v && v2l);
+  assert (raqm_get_visual_order (rq, NULL, NULL, 0) == text_len);
+  assert (raqm_get_visual_order (rq, l2v, v2l, text_len) == text_len);
+
+  for (size_t u = 0; u < text_len; u++)
+  {
+    assert (l2v[u] < text_len);
+    assert (v2l[l2v[u]] == u);
+  }
+
+  for (size_t r = 0; r < n; r++)
+  {
+    const raqm_run_info_t *run = &runs[r];
+    size_t end = run->start + run->length;
+
+    for (size_t u = run->start; u < end;)
+    {
+      size_t next = u + 1;
+
+      /* Skip UTF-8 continuation bytes */
+      while (next < end && (text[next] & 0xC0) == 0x80)
+        next++;
+
+      for (size_t k = u; k < next; k++)
+      {
+        if (run->direction == RAQM_DIRECTION_RTL)
+          assert (l2v[k] == visual + (end - next) + (k - u));
+        else
+          assert (l2v[k] == visual + (k - run->start));
+      }
+      u = next;
+    }
+
+    visual += run->length;
+  }
+  assert (visual == text_len);
+
+  free (l2v);
+  free (v2l);
+}
+
+static void
+test_text (FT_Face          face,
+           const char      *text,
+           raqm_direction_t direction)
+{
+  raqm_t *rq = raqm_create ();
+  size_t len = strlen (text);
+
+  assert (rq);
+  assert (raqm_get_cluster_map (rq, NULL, 0) == 0);
+  assert (raqm_get_visual_order (rq, NULL, NULL, 0) == 0);
+
+  assert (raqm_set_text_utf8 (rq, text, len));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_par_direction (rq, direction));
+  assert (raqm_layout (rq));
+
+  check_cluster_map (rq, len);
+  check_visual_order (rq, text, len);
+
+  raqm_destroy (rq);
+}
+
+/* A right-to-left mark with a language of its own makes a run of its own,
+ * which has no glyphs once default ignorables are removed. */
+static void
+test_empty_run (FT_Face face)
+{
+  const char *text = "abc \u200F def";
+  size_t len = strlen (text), mark = strlen ("abc ");
+  raqm_glyph_t *glyphs;
+  raqm_run_info_t runs[MAX_RUNS];
+  size_t count, n, *map;
+  raqm_t *rq = raqm_create ();
+  bool found = false;
+
+  assert (rq);
+  assert (raqm_set_text_utf8 (rq, text, len));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_language (rq, "fa", mark, 3));
+  assert (raqm_set_invisible_glyph (rq, -1));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs && count == len - 3);
+
+  n = raqm_get_runs (rq, runs, MAX_RUNS);
+  assert (n <= MAX_RUNS);
+  for (size_t r = 0; r < n; r++)
+  {
+    if (runs[r].glyphs_len)
+      continue;
+    assert (runs[r].start == mark && runs[r].length == 3);
+    found = true;
+  }
+  assert (found);
+
+  /* Poison the map to catch elements left unset */
+  map = malloc (sizeof (size_t) * len);
+  assert (map);
+  memset (map, 0xFF, sizeof (size_t) * len);
+  assert (raqm_get_cluster_map (rq, map, len) == len);
+  for (size_t u = 0; u < len; u++)
+    assert (map[u] <= count);
+  for (size_t u = mark; u < mark + 3; u++)
+    assert (map[u] == map[mark + 3]);
+
+  assert (raqm_get_cluster_map (rq, NULL, len) == len);
+
+  free (map);
+  raqm_destroy (rq);
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  test_text (face, "Hello e\xCC\x81 world", RAQM_DIRECTION_DEFAULT);
+  test_text (face, "abc عربي def", RAQM_DIRECTION_LTR);
+  test_text (face, "abc عربي def", RAQM_DIRECTION_RTL);
+  test_text (face, "عربي 😀 x", RAQM_DIRECTION_DEFAULT);
+  test_empty_run (face);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Font cache test.
+ *
+ * Verifies that a raqm_t reused with raqm_clear_contents() gives the same
+ * output as a fresh one, and that changing the size of a face between
+ * layouts is picked up even though the HarfBuzz font for it is cached, with
+ * both FreeType and OpenType font functions. Also verifies that with the
+ * font cache disabled, raqm_clear_contents() releases the faces so that
+ * their FreeType library can be freed before the raqm_t is destroyed.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+static int
+layout_width (raqm_t     *rq,
+              FT_Face     face,
+              int         flags,
+              const char *text)
+{
+  raqm_glyph_t *glyphs;
+  size_t count;
+  int width = 0;
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_freetype_load_flags (rq, flags));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs != NULL);
+  assert (count == strlen (text));
+
+  for (size_t i = 0; i < count; i++)
+  {
+    assert (glyphs[i].ftface == face);
+    width += glyphs[i].x_advance;
+  }
+
+  raqm_clear_contents (rq);
+
+  return width;
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face;
+  raqm_t *rq;
+  int width, width2;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  rq = raqm_create ();
+  assert (rq);
+
+  /* Reusing the same raqm_t gives the same output, and load flags are part
+   * of the cache key. */
+  width = layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello");
+  assert (width > 0);
+  assert (layout_width (rq, face, FT_LOAD_DEFAULT, "Hello") > 0);
+  assert (layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello") == width);
+
+  /* A new face size is picked up by the cached font. */
+  assert (!FT_Set_Char_Size (face, face->units_per_EM * 2, 0, 0, 0));
+  width2 = layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello");
+  assert (abs (width2 - width * 2) <= 5);
+
+  /* OpenType font functions give the same unhinted advances, and pick up a
+   * new face size too. */
+  assert (raqm_set_font_funcs (rq, RAQM_FONT_FUNCS_OPENTYPE));
+  assert (abs (layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello") -
+               width2) <= 5);
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+  assert (abs (layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello") -
+               width) <= 5);
+
+  raqm_destroy (rq);
+
+  /* The cached fonts must not outlive the raqm_t. */
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  /* With the font cache disabled, nothing references the face after
+   * raqm_clear_contents(). */
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  rq = raqm_create ();
+  assert (rq);
+  assert (!raqm_set_font_cache_size (rq, 17));
+  assert (layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello") == width);
+  assert (raqm_set_font_cache_size (rq, 0));
+  assert (layout_width (rq, face, FT_LOAD_NO_HINTING, "Hello") == width);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+  raqm_destroy (rq);
+
+  return 0;
+}
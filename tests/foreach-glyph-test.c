@@ -0,0 +1,99 @@
+/*
+ * Glyph iteration test.
+ *
+ * Verifies that raqm_layout_foreach_glyph() visits the same glyphs as
+ * raqm_get_glyphs() returns, with clusters in the input encoding, and that
+ * it stops when the callback asks it to.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "raqm.h"
+
+typedef struct
+{
+  const raqm_glyph_t *expected;
+  size_t              count;
+  size_t              stop_after;
+} visit_t;
+
+static bool
+check_glyph (const raqm_glyph_t *glyph,
+             void               *user_data)
+{
+  visit_t *visit = user_data;
+
+  assert (memcmp (glyph, &visit->expected[visit->count],
+                  sizeof (raqm_glyph_t)) == 0);
+  visit->count++;
+
+  return visit->count != visit->stop_after;
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *text = "Hello عربي é 😀";
+  FT_Library library;
+  FT_Face face;
+  raqm_t *rq;
+  raqm_glyph_t *glyphs;
+  size_t count;
+  visit_t visit = { NULL, 0, 0 };
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  rq = raqm_create ();
+  assert (rq);
+
+  /* Nothing to iterate before the layout */
+  assert (!raqm_layout_foreach_glyph (rq, check_glyph, &visit));
+  assert (visit.count == 0);
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_layout (rq));
+
+  /* Iterating first must not depend on raqm_get_glyphs() having converted
+   * the clusters. */
+  {
+    raqm_t *other = raqm_create ();
+    assert (other);
+    assert (raqm_set_text_utf8 (other, text, strlen (text)));
+    assert (raqm_set_freetype_face (other, face));
+    assert (raqm_layout (other));
+    glyphs = raqm_get_glyphs (other, &count);
+    assert (glyphs && count > 3);
+
+    visit.expected = glyphs;
+    assert (raqm_layout_foreach_glyph (rq, check_glyph, &visit));
+    assert (visit.count == count);
+    raqm_destroy (other);
+  }
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs);
+
+  visit.expected = glyphs;
+  visit.count = 0;
+  assert (raqm_layout_foreach_glyph (rq, check_glyph, &visit));
+  assert (visit.count == count);
+
+  /* Stopping early */
+  visit.count = 0;
+  visit.stop_after = 3;
+  assert (!raqm_layout_foreach_glyph (rq, check_glyph, &visit));
+  assert (visit.count == 3);
+
+  raqm_destroy (rq);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
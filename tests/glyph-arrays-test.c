@@ -0,0 +1,115 @@
+/*
+ * Glyph arrays test.
+ *
+ * Verifies that raqm_get_glyph_arrays() gives the same values as
+ * raqm_get_glyphs(), whole or in chunks, with any of the arrays left out.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "raqm.h"
+
+#define MAX_GLYPHS 64
+
+static void
+check_chunk (raqm_t             *rq,
+             const raqm_glyph_t *glyphs,
+             size_t              count,
+             size_t              start,
+             size_t              length)
+{
+  unsigned int indices[MAX_GLYPHS];
+  int x_advances[MAX_GLYPHS], y_advances[MAX_GLYPHS];
+  int x_offsets[MAX_GLYPHS], y_offsets[MAX_GLYPHS];
+  uint32_t clusters[MAX_GLYPHS];
+  size_t copied, expected;
+
+  expected = start < count ? count - start : 0;
+  if (expected > length)
+    expected = length;
+
+  copied = raqm_get_glyph_arrays (rq, start, length, indices, x_advances,
+                                  y_advances, x_offsets, y_offsets, clusters);
+  assert (copied == expected);
+
+  for (size_t i = 0; i < copied; i++)
+  {
+    const raqm_glyph_t *glyph = &glyphs[start + i];
+
+    assert (indices[i] == glyph->index);
+    assert (x_advances[i] == glyph->x_advance);
+    assert (y_advances[i] == glyph->y_advance);
+    assert (x_offsets[i] == glyph->x_offset);
+    assert (y_offsets[i] == glyph->y_offset);
+    assert (clusters[i] == glyph->cluster);
+  }
+}
+
+static void
+test_text (FT_Face     face,
+           const char *text)
+{
+  raqm_t *rq;
+  raqm_glyph_t *glyphs;
+  size_t count;
+
+  rq = raqm_create ();
+  assert (rq);
+
+  assert (raqm_get_glyph_arrays (rq, 0, SIZE_MAX, NULL, NULL, NULL,
+                                 NULL, NULL, NULL) == 0);
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs && count > 4 && count <= MAX_GLYPHS);
+
+  assert (raqm_get_glyph_arrays (rq, 0, SIZE_MAX, NULL, NULL, NULL,
+                                 NULL, NULL, NULL) == count);
+  assert (raqm_get_glyph_arrays (rq, 3, SIZE_MAX, NULL, NULL, NULL,
+                                 NULL, NULL, NULL) == count - 3);
+
+  check_chunk (rq, glyphs, count, 0, MAX_GLYPHS);
+  for (size_t start = 0; start <= count; start += 3)
+    check_chunk (rq, glyphs, count, start, 3);
+
+  /* Only some of the arrays */
+  {
+    int x_advances[MAX_GLYPHS];
+    uint32_t clusters[MAX_GLYPHS];
+
+    assert (raqm_get_glyph_arrays (rq, 0, count, NULL, x_advances, NULL,
+                                   NULL, NULL, clusters) == count);
+    for (size_t i = 0; i < count; i++)
+    {
+      assert (x_advances[i] == glyphs[i].x_advance);
+      assert (clusters[i] == glyphs[i].cluster);
+    }
+  }
+
+  raqm_destroy (rq);
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  test_text (face, "Hello عربي é 😀");
+  test_text (face, "abc def ghi");
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
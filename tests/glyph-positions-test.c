@@ -0,0 +1,149 @@
+/*
+ * Glyph positions test.
+ *
+ * Verifies that raqm_get_glyph_positions() gives the sum of the preceding
+ * advances plus the glyph offset, whole or in chunks carrying the pen
+ * position along, that snapping rounds each position without accumulating
+ * the rounding, and that positions out of the range of int are clamped.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "raqm.h"
+
+#define MAX_GLYPHS 64
+
+static int
+snap (long value,
+      int  grid)
+{
+  long floor;
+
+  if (grid <= 1)
+    return value;
+
+  value += grid / 2;
+  floor = value / grid;
+  if (value % grid < 0)
+    floor--;
+
+  return floor * grid;
+}
+
+static void
+check_positions (raqm_t             *rq,
+                 const raqm_glyph_t *glyphs,
+                 size_t              count,
+                 size_t              chunk,
+                 int                 grid)
+{
+  long x = 0, y = 0;
+  int64_t pen_x = 0, pen_y = 0;
+
+  for (size_t start = 0; start < count; start += chunk)
+  {
+    int x_positions[MAX_GLYPHS], y_positions[MAX_GLYPHS];
+    size_t n = raqm_get_glyph_positions (rq, start, chunk, &pen_x, &pen_y,
+                                         x_positions, y_positions, grid);
+
+    assert (n == (count - start < chunk ? count - start : chunk));
+    for (size_t i = 0; i < n; i++)
+    {
+      const raqm_glyph_t *glyph = &glyphs[start + i];
+
+      assert (x_positions[i] == snap (x + glyph->x_offset, grid));
+      assert (y_positions[i] == snap (y + glyph->y_offset, grid));
+      x += glyph->x_advance;
+      y += glyph->y_advance;
+    }
+    assert (pen_x == x && pen_y == y);
+  }
+}
+
+static void
+test_layout (FT_Face          face,
+             const char      *text,
+             raqm_direction_t direction,
+             int              letter_spacing)
+{
+  raqm_t *rq;
+  raqm_glyph_t *glyphs;
+  size_t count;
+
+  rq = raqm_create ();
+  assert (rq);
+
+  assert (raqm_get_glyph_positions (rq, 0, 1, NULL, NULL, NULL, NULL, 0) == 0);
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_par_direction (rq, direction));
+  if (letter_spacing)
+    assert (raqm_set_letter_spacing_range (rq, letter_spacing, 0,
+                                           strlen (text)));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs && count > 3 && count <= MAX_GLYPHS);
+
+  assert (raqm_get_glyph_positions (rq, count, 1, NULL, NULL, NULL, NULL,
+                                    0) == 0);
+  assert (raqm_get_glyph_positions (rq, 0, 1, NULL, NULL, NULL, NULL,
+                                    -1) == 0);
+
+  for (size_t chunk = 1; chunk <= count; chunk++)
+    check_positions (rq, glyphs, count, chunk, 0);
+  check_positions (rq, glyphs, count, count, 64);
+  check_positions (rq, glyphs, count, 3, 64);
+  check_positions (rq, glyphs, count, count, 1);
+
+  /* Positions out of the range of int are clamped, the pen is not. */
+  {
+    int x_positions[MAX_GLYPHS];
+    int64_t width = 0, pen_x;
+
+    for (size_t i = 0; i < count; i++)
+      width += glyphs[i].x_advance;
+
+    pen_x = (int64_t) INT_MAX + 1000;
+    assert (raqm_get_glyph_positions (rq, 0, count, &pen_x, NULL,
+                                      x_positions, NULL, 64) == count);
+    assert (pen_x == (int64_t) INT_MAX + 1000 + width);
+    for (size_t i = 0; i < count; i++)
+      assert (x_positions[i] == INT_MAX);
+
+    pen_x = (int64_t) INT_MIN - 1000 - width;
+    assert (raqm_get_glyph_positions (rq, 0, count, &pen_x, NULL,
+                                      x_positions, NULL, 0) == count);
+    assert (pen_x == (int64_t) INT_MIN - 1000);
+    for (size_t i = 0; i < count; i++)
+      assert (x_positions[i] == INT_MIN);
+  }
+
+  raqm_destroy (rq);
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  test_layout (face, "Hello world", RAQM_DIRECTION_DEFAULT, 0);
+  test_layout (face, "Hello world", RAQM_DIRECTION_DEFAULT, 37);
+  test_layout (face, "Hello world", RAQM_DIRECTION_TTB, 0);
+  test_layout (face, "abc عربي def", RAQM_DIRECTION_RTL, 37);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
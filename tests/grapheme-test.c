@@ -2,7 +2,8 @@
  * Unicode Grapheme Cluster Break conformance test.
  *
  * Parses GraphemeBreakTest.txt and verifies that
- * raqm_allowed_grapheme_boundary produces correct results.
+ * raqm_allowed_grapheme_boundary and raqm_get_grapheme_boundaries produce
+ * correct results.
  */
 
 #include <stdbool.h>
@@ -121,6 +122,31 @@ run_tests (const char *path)
       }
     }
 
+    /* The bulk query must agree, with the start and end of text added. */
+    size_t offsets[257];
+    size_t count = raqm_get_grapheme_boundaries (rq, offsets, 257);
+    size_t expected_count = 0;
+    for (size_t i = 0; i <= n; i++)
+    {
+      if (i != 0 && i != n && !breaks[i])
+        continue;
+
+      if (expected_count >= count || offsets[expected_count] != i)
+      {
+        fprintf (stderr, "FAIL test %d: bulk boundary %zu should be at %zu\n",
+                 test_num, expected_count, i);
+        failures++;
+        break;
+      }
+      expected_count++;
+    }
+    if (count != expected_count)
+    {
+      fprintf (stderr, "FAIL test %d: %zu bulk boundaries, expected %zu\n",
+               test_num, count, expected_count);
+      failures++;
+    }
+
     raqm_destroy (rq);
   }
 
@@ -134,6 +160,43 @@ run_tests (const char *path)
   return failures ? 1 : 0;
 }
 
+/* Bulk boundaries are given in the input encoding. */
+static int
+test_utf8_boundaries (void)
+{
+  /* e + COMBINING ACUTE ACCENT, x, then the flags of Oman and Saudi Arabia */
+  const char *text = "e\xCC\x81x\xF0\x9F\x87\xB4\xF0\x9F\x87\xB2"
+                     "\xF0\x9F\x87\xB8\xF0\x9F\x87\xA6";
+  const size_t expected[] = { 0, 3, 4, 12, 20 };
+  size_t offsets[5];
+  int failures = 0;
+  raqm_t *rq = raqm_create ();
+
+  if (!rq || !raqm_set_text_utf8 (rq, text, strlen (text)))
+  {
+    fprintf (stderr, "FAIL UTF-8: raqm_create/raqm_set_text_utf8 failed\n");
+    raqm_destroy (rq);
+    return 1;
+  }
+
+  if (raqm_get_grapheme_boundaries (rq, NULL, 0) != 5 ||
+      raqm_get_grapheme_boundaries (rq, NULL, 5) != 5 ||
+      raqm_get_grapheme_boundaries (rq, offsets, 2) != 5 ||
+      offsets[0] != 0 || offsets[1] != 3)
+    failures++;
+
+  if (raqm_get_grapheme_boundaries (rq, offsets, 5) != 5 ||
+      memcmp (offsets, expected, sizeof (expected)) != 0)
+    failures++;
+
+  if (failures)
+    fprintf (stderr, "FAIL UTF-8 bulk boundaries\n");
+
+  raqm_destroy (rq);
+
+  return failures;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -143,5 +206,5 @@ main (int argc, char **argv)
     return 1;
   }
 
-  return run_tests (argv[1]);
+  return run_tests (argv[1]) || test_utf8_boundaries ();
 }
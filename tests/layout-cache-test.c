@@ -0,0 +1,161 @@
+/*
+ * Layout cache test.
+ *
+ * Verifies that layouts found in the layout cache give the same output as
+ * when they were first done, that the hits and misses are counted, and that
+ * changing the text, its direction or the face size is not mistaken for a
+ * cached layout.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+static raqm_glyph_t *
+layout (raqm_t          *rq,
+        FT_Face          face,
+        const char      *text,
+        raqm_direction_t dir,
+        size_t          *count)
+{
+  raqm_glyph_t *glyphs, *copy;
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_par_direction (rq, dir));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, count);
+  assert (glyphs != NULL);
+
+  copy = malloc (sizeof (raqm_glyph_t) * *count);
+  assert (copy);
+  memcpy (copy, glyphs, sizeof (raqm_glyph_t) * *count);
+
+  raqm_clear_contents (rq);
+
+  return copy;
+}
+
+static void
+assert_stats (raqm_t *rq,
+              size_t  expected_hits,
+              size_t  expected_misses)
+{
+  size_t hits, misses;
+
+  raqm_get_layout_cache_stats (rq, &hits, &misses);
+  assert (hits == expected_hits);
+  assert (misses == expected_misses);
+}
+
+static void
+assert_same (raqm_glyph_t *a,
+             size_t        a_count,
+             raqm_glyph_t *b,
+             size_t        b_count)
+{
+  assert (a_count == b_count);
+  assert (memcmp (a, b, sizeof (raqm_glyph_t) * a_count) == 0);
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *text = "Hello عربي";
+  FT_Library library;
+  FT_Face face;
+  raqm_t *rq;
+  raqm_glyph_t *uncached, *first, *second;
+  size_t uncached_count, first_count, second_count;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  rq = raqm_create ();
+  assert (rq);
+
+  uncached = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &uncached_count);
+  assert_stats (rq, 0, 0);
+
+  assert (raqm_set_layout_cache_size (rq, 8, 0));
+
+  first = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &first_count);
+  assert_stats (rq, 0, 1);
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 1, 1);
+
+  assert_same (uncached, uncached_count, first, first_count);
+  assert_same (first, first_count, second, second_count);
+
+  /* The resolved direction and the runs are restored too. */
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_layout (rq));
+  assert_stats (rq, 2, 1);
+  assert (raqm_get_par_resolved_direction (rq) == RAQM_DIRECTION_LTR);
+  {
+    int x, y;
+    size_t index = 6;
+    assert (raqm_index_to_position (rq, &index, &x, &y));
+  }
+  raqm_clear_contents (rq);
+  free (second);
+
+  /* Different text or direction misses. */
+  second = layout (rq, face, "Hello", RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 2, 2);
+  free (second);
+
+  second = layout (rq, face, text, RAQM_DIRECTION_RTL, &second_count);
+  assert_stats (rq, 2, 3);
+  free (second);
+
+  /* Shaping word by word can give different output, so enabling the word
+   * cache misses. */
+  assert (raqm_set_word_cache_size (rq, 64));
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 2, 4);
+  free (second);
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 3, 4);
+  free (second);
+  assert (raqm_set_word_cache_size (rq, 0));
+
+  /* A new face size misses. */
+  assert (!FT_Set_Char_Size (face, face->units_per_EM * 2, 0, 0, 0));
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 3, 5);
+  assert (second_count == first_count);
+  assert (second[0].x_advance != first[0].x_advance);
+  free (second);
+
+  /* A byte budget smaller than any layout keeps nothing, but still gives the
+   * same output. */
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+  assert (raqm_set_layout_cache_size (rq, 8, 1));
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_same (first, first_count, second, second_count);
+  free (second);
+  second = layout (rq, face, text, RAQM_DIRECTION_DEFAULT, &second_count);
+  assert_stats (rq, 3, 7);
+  assert_same (first, first_count, second, second_count);
+
+  /* Disabling the cache drops the cached layouts. */
+  assert (raqm_set_layout_cache_size (rq, 0, 0));
+
+  free (uncached);
+  free (first);
+  free (second);
+  raqm_destroy (rq);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Run output test.
+ *
+ * Verifies that raqm_get_runs() gives the runs in visual order, covering the
+ * input text and the output glyphs without gaps, with the direction, script,
+ * language and font of their text.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "raqm.h"
+
+#define MAX_RUNS 16
+
+#define TAG(a, b, c, d) \
+  (((uint32_t) (a) << 24) | ((uint32_t) (b) << 16) | \
+   ((uint32_t) (c) << 8) | (uint32_t) (d))
+
+int
+main (int argc, char **argv)
+{
+  /* Latin, Arabic, Latin in an LTR paragraph */
+  const char *text = "abc عربي def";
+  size_t arabic_start = strlen ("abc ");
+  size_t arabic_end = arabic_start + strlen ("عربي");
+  FT_Library library;
+  FT_Face face;
+  raqm_t *rq;
+  raqm_run_info_t runs[MAX_RUNS];
+  raqm_glyph_t *glyphs;
+  size_t count, n, covered, next_glyph;
+
+  assert (argc == 2);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  rq = raqm_create ();
+  assert (rq);
+
+  assert (raqm_get_runs (rq, runs, MAX_RUNS) == 0);
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_set_par_direction (rq, RAQM_DIRECTION_LTR));
+  assert (raqm_set_language (rq, "ar", arabic_start,
+                             arabic_end - arabic_start));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, &count);
+  assert (glyphs);
+
+  n = raqm_get_runs (rq, NULL, 0);
+  assert (n >= 3 && n <= MAX_RUNS);
+  assert (raqm_get_runs (rq, runs, 1) == n);
+  assert (runs[0].start == 0);
+  assert (raqm_get_runs (rq, runs, MAX_RUNS) == n);
+
+  covered = 0;
+  next_glyph = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    assert (runs[i].ftface == face);
+    assert (runs[i].glyphs_start == next_glyph);
+    next_glyph += runs[i].glyphs_len;
+
+    for (size_t j = 0; j < runs[i].glyphs_len; j++)
+    {
+      uint32_t cluster = glyphs[runs[i].glyphs_start + j].cluster;
+      assert (cluster >= runs[i].start);
+      assert (cluster < runs[i].start + runs[i].length);
+    }
+    covered += runs[i].length;
+  }
+  assert (next_glyph == count);
+  assert (covered == strlen (text));
+
+  /* Visual order in an LTR paragraph is the logical order of the runs */
+  for (size_t i = 1; i < n; i++)
+    assert (runs[i].start == runs[i - 1].start + runs[i - 1].length);
+
+  assert (runs[0].start == 0);
+  assert (runs[0].direction == RAQM_DIRECTION_LTR);
+  assert (runs[0].script == TAG ('L', 'a', 't', 'n'));
+
+  assert (runs[1].start == arabic_start);
+  assert (runs[1].length == arabic_end - arabic_start);
+  assert (runs[1].direction == RAQM_DIRECTION_RTL);
+  assert (runs[1].script == TAG ('A', 'r', 'a', 'b'));
+  assert (runs[1].language && strcmp (runs[1].language, "ar") == 0);
+
+  assert (runs[n - 1].direction == RAQM_DIRECTION_LTR);
+  assert (runs[n - 1].script == TAG ('L', 'a', 't', 'n'));
+
+  raqm_destroy (rq);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * Word cache test.
+ *
+ * Verifies that words found in the word cache give the same output as when
+ * they were first shaped, that the hits and misses are counted, that the
+ * glyphs match the ones from shaping without the cache, that a saved
+ * cache file gives the same output when loaded, that a truncated cache
+ * file is not read out of bounds, and that changing the coordinates of a
+ * variable font is not hidden by the cache.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raqm.h"
+
+#include FT_MULTIPLE_MASTERS_H
+
+#define CACHE_FILE "word-cache-test.cache"
+
+static raqm_glyph_t *
+layout (raqm_t     *rq,
+        FT_Face     face,
+        const char *text,
+        size_t     *count)
+{
+  raqm_glyph_t *glyphs, *copy;
+
+  assert (raqm_set_text_utf8 (rq, text, strlen (text)));
+  assert (raqm_set_freetype_face (rq, face));
+  assert (raqm_layout (rq));
+
+  glyphs = raqm_get_glyphs (rq, count);
+  assert (glyphs != NULL);
+
+  copy = malloc (sizeof (raqm_glyph_t) * *count);
+  assert (copy);
+  memcpy (copy, glyphs, sizeof (raqm_glyph_t) * *count);
+
+  raqm_clear_contents (rq);
+
+  return copy;
+}
+
+static void
+test_text (FT_Face     face,
+           const char *text,
+           size_t      words,
+           size_t      unique_words)
+{
+  raqm_t *rq;
+  raqm_glyph_t *uncached, *first, *second;
+  size_t uncached_count, first_count, second_count;
+  size_t hits, misses;
+
+  rq = raqm_create ();
+  assert (rq);
+
+  uncached = layout (rq, face, text, &uncached_count);
+  raqm_get_word_cache_stats (rq, &hits, &misses);
+  assert (hits == 0 && misses == 0);
+
+  assert (raqm_set_word_cache_size (rq, 64));
+
+  first = layout (rq, face, text, &first_count);
+  raqm_get_word_cache_stats (rq, &hits, &misses);
+  assert (misses == unique_words);
+  assert (hits == words - unique_words);
+
+  second = layout (rq, face, text, &second_count);
+  raqm_get_word_cache_stats (rq, &hits, &misses);
+  assert (misses == unique_words);
+  assert (hits == 2 * words - unique_words);
+
+  assert (first_count == second_count);
+  assert (memcmp (first, second, sizeof (raqm_glyph_t) * first_count) == 0);
+
+  assert (uncached_count == first_count);
+  for (size_t i = 0; i < first_count; i++)
+  {
+    assert (uncached[i].index == first[i].index);
+    assert (uncached[i].cluster == first[i].cluster);
+  }
+
+  /* A cache too small for all the words still gives the same output. */
+  assert (raqm_set_word_cache_size (rq, 1));
+  free (second);
+  second = layout (rq, face, text, &second_count);
+  assert (first_count == second_count);
+  assert (memcmp (first, second, sizeof (raqm_glyph_t) * first_count) == 0);
+
+  /* Words loaded from a cache file are not shaped again. */
+  assert (raqm_set_word_cache_size (rq, 64));
+  free (second);
+  second = layout (rq, face, text, &second_count);
+  assert (raqm_save_word_cache (rq, CACHE_FILE));
+  raqm_destroy (rq);
+
+  rq = raqm_create ();
+  assert (rq);
+  assert (!raqm_load_word_cache (rq, "no-such-file"));
+  assert (raqm_load_word_cache (rq, CACHE_FILE));
+  assert (raqm_set_word_cache_size (rq, 64));
+
+  free (second);
+  second = layout (rq, face, text, &second_count);
+  raqm_get_word_cache_stats (rq, &hits, &misses);
+  assert (misses == 0);
+  assert (hits == words);
+  assert (first_count == second_count);
+  assert (memcmp (first, second, sizeof (raqm_glyph_t) * first_count) == 0);
+
+  remove (CACHE_FILE);
+
+  free (uncached);
+  free (first);
+  free (second);
+  raqm_destroy (rq);
+}
+
+/* A file with a valid header and a single bucket pointing inside the file,
+ * but too small to hold an entry. */
+static void
+test_truncated_file (FT_Face face)
+{
+  const char *text = "the cat";
+  unsigned char data[44];
+  uint32_t size = sizeof (data), buckets_len = 1, bucket = 4;
+  raqm_t *rq;
+  raqm_glyph_t *expected, *glyphs;
+  size_t expected_count, count;
+  FILE *file;
+
+  rq = raqm_create ();
+  assert (rq);
+  assert (raqm_set_word_cache_size (rq, 64));
+  expected = layout (rq, face, text, &expected_count);
+  assert (raqm_save_word_cache (rq, CACHE_FILE));
+  raqm_destroy (rq);
+
+  /* Keep the 40 bytes header, and patch its size and buckets length. */
+  file = fopen (CACHE_FILE, "rb");
+  assert (file);
+  assert (fread (data, 1, 40, file) == 40);
+  fclose (file);
+  memcpy (data + 28, &size, sizeof (uint32_t));
+  memcpy (data + 36, &buckets_len, sizeof (uint32_t));
+  memcpy (data + 40, &bucket, sizeof (uint32_t));
+
+  file = fopen (CACHE_FILE, "wb");
+  assert (file);
+  assert (fwrite (data, 1, sizeof (data), file) == sizeof (data));
+  fclose (file);
+
+  rq = raqm_create ();
+  assert (rq);
+  assert (raqm_load_word_cache (rq, CACHE_FILE));
+  assert (raqm_set_word_cache_size (rq, 64));
+  glyphs = layout (rq, face, text, &count);
+  assert (count == expected_count);
+  assert (memcmp (glyphs, expected, sizeof (raqm_glyph_t) * count) == 0);
+
+  remove (CACHE_FILE);
+
+  free (expected);
+  free (glyphs);
+  raqm_destroy (rq);
+}
+
+static void
+set_weight (FT_Face face,
+            int     weight)
+{
+  FT_Fixed coords[1];
+
+  coords[0] = (FT_Fixed) weight << 16;
+  assert (!FT_Set_Var_Design_Coordinates (face, 1, coords));
+}
+
+/* The test variable font has a single weight axis from 400 to 700, and all
+ * its advances grow with it. */
+static void
+test_variable_font (FT_Face face)
+{
+  const char *text = "aa aa aa";
+  raqm_t *rq, *uncached_rq;
+  raqm_glyph_t *light, *bold, *uncached, *glyphs;
+  size_t light_count, bold_count, uncached_count, count;
+
+  assert (FT_HAS_MULTIPLE_MASTERS (face));
+
+  rq = raqm_create ();
+  uncached_rq = raqm_create ();
+  assert (rq && uncached_rq);
+  assert (raqm_set_word_cache_size (rq, 64));
+
+  set_weight (face, 400);
+  light = layout (rq, face, text, &light_count);
+
+  set_weight (face, 700);
+  bold = layout (rq, face, text, &bold_count);
+  uncached = layout (uncached_rq, face, text, &uncached_count);
+
+  assert (bold_count == light_count);
+  assert (bold[0].x_advance > light[0].x_advance);
+  assert (uncached_count == bold_count);
+  assert (memcmp (uncached, bold, sizeof (raqm_glyph_t) * bold_count) == 0);
+
+  set_weight (face, 400);
+  glyphs = layout (rq, face, text, &count);
+  assert (count == light_count);
+  assert (memcmp (glyphs, light, sizeof (raqm_glyph_t) * count) == 0);
+
+  free (light);
+  free (bold);
+  free (uncached);
+  free (glyphs);
+  raqm_destroy (rq);
+  raqm_destroy (uncached_rq);
+}
+
+int
+main (int argc, char **argv)
+{
+  FT_Library library;
+  FT_Face face, variable_face;
+
+  assert (argc == 3);
+
+  assert (!FT_Init_FreeType (&library));
+  assert (!FT_New_Face (library, argv[1], 0, &face));
+  assert (!FT_Set_Char_Size (face, face->units_per_EM, 0, 0, 0));
+
+  /* the, cat, and, dog, and the spaces between them. */
+  test_text (face, "the cat and the dog", 9, 5);
+
+  /* Right-to-left words, with repeated spaces. */
+  test_text (face, "عربي  عربي عربي", 5, 3);
+
+  test_truncated_file (face);
+
+  assert (!FT_New_Face (library, argv[2], 0, &variable_face));
+  assert (!FT_Set_Char_Size (variable_face, variable_face->units_per_EM,
+                             0, 0, 0));
+  test_variable_font (variable_face);
+  FT_Done_Face (variable_face);
+
+  FT_Done_Face (face);
+  FT_Done_FreeType (library);
+
+  return 0;
+}